@@ -46,6 +46,15 @@ else ifeq ($(strip $(DEBUG_MATRIX_SCAN_RATE_ENABLE)), api)
     OPT_DEFS += -DDEBUG_MATRIX_SCAN_RATE
 endif
 
+ifeq ($(strip $(TASK_TIMING_ENABLE)), yes)
+    OPT_DEFS += -DTASK_TIMING_ENABLE
+    SRC += $(QUANTUM_DIR)/task_timing.c
+    CONSOLE_ENABLE = yes
+else ifeq ($(strip $(TASK_TIMING_ENABLE)), api)
+    OPT_DEFS += -DTASK_TIMING_ENABLE
+    SRC += $(QUANTUM_DIR)/task_timing.c
+endif
+
 ifeq ($(strip $(API_SYSEX_ENABLE)), yes)
     OPT_DEFS += -DAPI_SYSEX_ENABLE
     OPT_DEFS += -DAPI_ENABLE
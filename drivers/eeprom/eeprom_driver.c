@@ -18,6 +18,19 @@
 #include <string.h>
 
 #include "eeprom_driver.h"
+#if defined(EEPROM_I2C)
+#    include "eeprom_i2c.h"
+#elif defined(EEPROM_SPI)
+#    include "eeprom_spi.h"
+#endif
+
+#ifndef EEPROM_UPDATE_CHUNK_SIZE
+#    if defined(EXTERNAL_EEPROM_PAGE_SIZE)
+#        define EEPROM_UPDATE_CHUNK_SIZE EXTERNAL_EEPROM_PAGE_SIZE
+#    else
+#        define EEPROM_UPDATE_CHUNK_SIZE 32
+#    endif
+#endif
 
 uint8_t eeprom_read_byte(const uint8_t *addr) {
     uint8_t ret = 0;
@@ -44,10 +57,25 @@ void eeprom_write_word(uint16_t *addr, uint16_t value) { eeprom_write_block(&val
 void eeprom_write_dword(uint32_t *addr, uint32_t value) { eeprom_write_block(&value, addr, 4); }
 
 void eeprom_update_block(const void *buf, void *addr, size_t len) {
-    uint8_t read_buf[len];
-    eeprom_read_block(read_buf, addr, len);
-    if (memcmp(buf, read_buf, len) != 0) {
-        eeprom_write_block(buf, addr, len);
+    const uint8_t *src         = (const uint8_t *)buf;
+    uintptr_t      target_addr = (uintptr_t)addr;
+    uint8_t        read_buf[EEPROM_UPDATE_CHUNK_SIZE];
+
+    // Compare page by page, so only the pages that changed get written
+    while (len > 0) {
+        size_t chunk_length = EEPROM_UPDATE_CHUNK_SIZE - (target_addr % EEPROM_UPDATE_CHUNK_SIZE);
+        if (chunk_length > len) {
+            chunk_length = len;
+        }
+
+        eeprom_read_block(read_buf, (const void *)target_addr, chunk_length);
+        if (memcmp(src, read_buf, chunk_length) != 0) {
+            eeprom_write_block(src, (void *)target_addr, chunk_length);
+        }
+
+        src += chunk_length;
+        target_addr += chunk_length;
+        len -= chunk_length;
     }
 }
 
@@ -19,6 +19,14 @@
 #include "i2c_master.h"
 #include "wait.h"
 
+#ifdef RGB_MATRIX_ASYNC_FLUSH
+#    include "atomic_util.h"
+// The rgb_flush thread clears the update flags while the main thread sets them
+#    define ISSI_UPDATE_FLAGS_ATOMIC ATOMIC_BLOCK_FORCEON
+#else
+#    define ISSI_UPDATE_FLAGS_ATOMIC
+#endif
+
 // This is a 7-bit address, that gets left-shifted and bit 0
 // set to 0 for write, 1 for read (as per I2C protocol)
 // The address will vary depending on your wiring:
@@ -61,8 +69,10 @@ uint8_t g_twi_transfer_buffer[20];
 // We could optimize this and take out the unused registers from these
 // buffers and the transfers in IS31FL3731_write_pwm_buffer() but it's
 // probably not worth the extra complexity.
-uint8_t g_pwm_buffer[DRIVER_COUNT][144];
-bool    g_pwm_buffer_update_required[DRIVER_COUNT] = {false};
+// Each bit of the update flags marks a 16 byte chunk that changed since it
+// was last transferred, so the other chunks still match the PWM registers.
+uint8_t  g_pwm_buffer[DRIVER_COUNT][144];
+uint16_t g_pwm_buffer_update_required[DRIVER_COUNT] = {0};
 
 uint8_t g_led_control_registers[DRIVER_COUNT][18]             = {{0}};
 bool    g_led_control_registers_update_required[DRIVER_COUNT] = {false};
@@ -94,30 +104,35 @@ void IS31FL3731_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
 #endif
 }
 
-void IS31FL3731_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+static bool IS31FL3731_write_pwm_chunk(uint8_t addr, uint8_t *pwm_buffer, uint8_t chunk) {
     // assumes bank is already selected
-
-    // transmit PWM registers in 9 transfers of 16 bytes
     // g_twi_transfer_buffer[] is 20 bytes
 
-    // iterate over the pwm_buffer contents at 16 byte intervals
-    for (int i = 0; i < 144; i += 16) {
-        // set the first register, e.g. 0x24, 0x34, 0x44, etc.
-        g_twi_transfer_buffer[0] = 0x24 + i;
-        // copy the data from i to i+15
-        // device will auto-increment register for data after the first byte
-        // thus this sets registers 0x24-0x33, 0x34-0x43, etc. in one transfer
-        for (int j = 0; j < 16; j++) {
-            g_twi_transfer_buffer[1 + j] = pwm_buffer[i + j];
-        }
+    // set the first register, e.g. 0x24, 0x34, 0x44, etc.
+    g_twi_transfer_buffer[0] = 0x24 + chunk * 16;
+    // copy the 16 bytes of the chunk
+    // device will auto-increment register for data after the first byte
+    // thus this sets registers 0x24-0x33, 0x34-0x43, etc. in one transfer
+    for (int j = 0; j < 16; j++) {
+        g_twi_transfer_buffer[1 + j] = pwm_buffer[chunk * 16 + j];
+    }
 
 #if ISSI_PERSISTENCE > 0
-        for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0) break;
-        }
+    for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
+        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0) return true;
+    }
+    return false;
 #else
-        i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT);
+    return i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0;
 #endif
+}
+
+void IS31FL3731_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+    // assumes bank is already selected
+
+    // transmit PWM registers in 9 transfers of 16 bytes
+    for (uint8_t chunk = 0; chunk < 9; chunk++) {
+        IS31FL3731_write_pwm_chunk(addr, pwm_buffer, chunk);
     }
 }
 
@@ -173,15 +188,24 @@ void IS31FL3731_init(uint8_t addr) {
     IS31FL3731_write_register(addr, ISSI_COMMANDREGISTER, 0);
 }
 
+static void IS31FL3731_set_pwm_register(uint8_t driver, uint8_t reg, uint8_t value) {
+    // Subtract 0x24 to get the second index of g_pwm_buffer
+    uint8_t i = reg - 0x24;
+
+    // only a changed value needs its chunk sent again
+    if (g_pwm_buffer[driver][i] != value) {
+        g_pwm_buffer[driver][i] = value;
+        ISSI_UPDATE_FLAGS_ATOMIC { g_pwm_buffer_update_required[driver] |= 1 << (i / 16); }
+    }
+}
+
 void IS31FL3731_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     if (index >= 0 && index < DRIVER_LED_TOTAL) {
         is31_led led = g_is31_leds[index];
 
-        // Subtract 0x24 to get the second index of g_pwm_buffer
-        g_pwm_buffer[led.driver][led.r - 0x24]   = red;
-        g_pwm_buffer[led.driver][led.g - 0x24]   = green;
-        g_pwm_buffer[led.driver][led.b - 0x24]   = blue;
-        g_pwm_buffer_update_required[led.driver] = true;
+        IS31FL3731_set_pwm_register(led.driver, led.r, red);
+        IS31FL3731_set_pwm_register(led.driver, led.g, green);
+        IS31FL3731_set_pwm_register(led.driver, led.b, blue);
     }
 }
 
@@ -222,9 +246,19 @@ void IS31FL3731_set_led_control_register(uint8_t index, bool red, bool green, bo
 
 void IS31FL3731_update_pwm_buffers(uint8_t addr, uint8_t index) {
     if (g_pwm_buffer_update_required[index]) {
-        IS31FL3731_write_pwm_buffer(addr, g_pwm_buffer[index]);
+        // only transfer the chunks that changed, one that fails is flagged again
+        // so it is sent again with the next update
+        for (uint8_t chunk = 0; chunk < 9; chunk++) {
+            if (g_pwm_buffer_update_required[index] & (1 << chunk)) {
+                // clear the flag before copying, so a change made while the chunk
+                // is being sent flags it again
+                ISSI_UPDATE_FLAGS_ATOMIC { g_pwm_buffer_update_required[index] &= ~(1 << chunk); }
+                if (!IS31FL3731_write_pwm_chunk(addr, g_pwm_buffer[index], chunk)) {
+                    ISSI_UPDATE_FLAGS_ATOMIC { g_pwm_buffer_update_required[index] |= 1 << chunk; }
+                }
+            }
+        }
     }
-    g_pwm_buffer_update_required[index] = false;
 }
 
 void IS31FL3731_update_led_control_registers(uint8_t addr, uint8_t index) {
@@ -18,6 +18,14 @@
 #include "i2c_master.h"
 #include "wait.h"
 
+#ifdef RGB_MATRIX_ASYNC_FLUSH
+#    include "atomic_util.h"
+// The rgb_flush thread clears the update flags while the main thread sets them
+#    define ISSI_UPDATE_FLAGS_ATOMIC ATOMIC_BLOCK_FORCEON
+#else
+#    define ISSI_UPDATE_FLAGS_ATOMIC
+#endif
+
 // This is a 7-bit address, that gets left-shifted and bit 0
 // set to 0 for write, 1 for read (as per I2C protocol)
 // The address will vary depending on your wiring:
@@ -63,48 +71,64 @@ uint8_t g_twi_transfer_buffer[20];
 // We could optimize this and take out the unused registers from these
 // buffers and the transfers in IS31FL3736_write_pwm_buffer() but it's
 // probably not worth the extra complexity.
-uint8_t g_pwm_buffer[DRIVER_COUNT][192];
-bool    g_pwm_buffer_update_required = false;
+// Each bit of the update flags marks a 16 byte chunk that changed since it
+// was last transferred, so the other chunks still match the PWM registers.
+uint8_t  g_pwm_buffer[DRIVER_COUNT][192];
+uint16_t g_pwm_buffer_update_required[DRIVER_COUNT] = {0};
 
 uint8_t g_led_control_registers[DRIVER_COUNT][24] = {{0}, {0}};
 bool    g_led_control_registers_update_required   = false;
 
-void IS31FL3736_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
+bool IS31FL3736_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
+    // if the transaction fails function returns false
     g_twi_transfer_buffer[0] = reg;
     g_twi_transfer_buffer[1] = data;
 
 #if ISSI_PERSISTENCE > 0
     for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 2, ISSI_TIMEOUT) == 0) break;
+        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 2, ISSI_TIMEOUT) == 0) return true;
     }
+    return false;
 #else
-    i2c_transmit(addr << 1, g_twi_transfer_buffer, 2, ISSI_TIMEOUT);
+    return i2c_transmit(addr << 1, g_twi_transfer_buffer, 2, ISSI_TIMEOUT) == 0;
 #endif
 }
 
-void IS31FL3736_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+static bool IS31FL3736_write_pwm_chunk(uint8_t addr, uint8_t *pwm_buffer, uint8_t chunk) {
     // assumes PG1 is already selected
-
-    // transmit PWM registers in 12 transfers of 16 bytes
     // g_twi_transfer_buffer[] is 20 bytes
-
-    // iterate over the pwm_buffer contents at 16 byte intervals
-    for (int i = 0; i < 192; i += 16) {
-        g_twi_transfer_buffer[0] = i;
-        // copy the data from i to i+15
-        // device will auto-increment register for data after the first byte
-        // thus this sets registers 0x00-0x0F, 0x10-0x1F, etc. in one transfer
-        for (int j = 0; j < 16; j++) {
-            g_twi_transfer_buffer[1 + j] = pwm_buffer[i + j];
-        }
+    g_twi_transfer_buffer[0] = chunk * 16;
+    // copy the 16 bytes of the chunk
+    // device will auto-increment register for data after the first byte
+    // thus this sets registers 0x00-0x0F, 0x10-0x1F, etc. in one transfer
+    for (int j = 0; j < 16; j++) {
+        g_twi_transfer_buffer[1 + j] = pwm_buffer[chunk * 16 + j];
+    }
 
 #if ISSI_PERSISTENCE > 0
-        for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0) break;
-        }
+    for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
+        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0) return true;
+    }
+    return false;
 #else
-        i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT);
+    return i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0;
 #endif
+}
+
+void IS31FL3736_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+    // assumes PG1 is already selected
+
+    // transmit PWM registers in 12 transfers of 16 bytes
+    for (uint8_t chunk = 0; chunk < 12; chunk++) {
+        IS31FL3736_write_pwm_chunk(addr, pwm_buffer, chunk);
+    }
+}
+
+static void IS31FL3736_set_pwm_register(uint8_t driver, uint8_t reg, uint8_t value) {
+    // only a changed value needs its chunk sent again
+    if (g_pwm_buffer[driver][reg] != value) {
+        g_pwm_buffer[driver][reg] = value;
+        ISSI_UPDATE_FLAGS_ATOMIC { g_pwm_buffer_update_required[driver] |= 1 << (reg / 16); }
     }
 }
 
@@ -153,10 +177,9 @@ void IS31FL3736_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     if (index >= 0 && index < DRIVER_LED_TOTAL) {
         is31_led led = g_is31_leds[index];
 
-        g_pwm_buffer[led.driver][led.r] = red;
-        g_pwm_buffer[led.driver][led.g] = green;
-        g_pwm_buffer[led.driver][led.b] = blue;
-        g_pwm_buffer_update_required    = true;
+        IS31FL3736_set_pwm_register(led.driver, led.r, red);
+        IS31FL3736_set_pwm_register(led.driver, led.g, green);
+        IS31FL3736_set_pwm_register(led.driver, led.b, blue);
     }
 }
 
@@ -213,9 +236,8 @@ void IS31FL3736_mono_set_brightness(int index, uint8_t value) {
     if (index >= 0 && index < 96) {
         // Index in range 0..95 -> A1..A8, B1..B8, etc.
         // Map index 0..95 to registers 0x00..0xBE (interleaved)
-        uint8_t pwm_register          = index * 2;
-        g_pwm_buffer[0][pwm_register] = value;
-        g_pwm_buffer_update_required  = true;
+        uint8_t pwm_register = index * 2;
+        IS31FL3736_set_pwm_register(0, pwm_register, value);
     }
 }
 
@@ -244,15 +266,27 @@ void IS31FL3736_mono_set_led_control_register(uint8_t index, bool enabled) {
 }
 
 void IS31FL3736_update_pwm_buffers(uint8_t addr1, uint8_t addr2) {
-    if (g_pwm_buffer_update_required) {
+    if (g_pwm_buffer_update_required[0]) {
         // Firstly we need to unlock the command register and select PG1
-        IS31FL3736_write_register(addr1, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
-        IS31FL3736_write_register(addr1, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM);
+        // without PG1 the chunks would end up elsewhere, so leave them all for the next update
+        if (!IS31FL3736_write_register(addr1, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5) || !IS31FL3736_write_register(addr1, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM)) {
+            return;
+        }
 
-        IS31FL3736_write_pwm_buffer(addr1, g_pwm_buffer[0]);
+        // only transfer the chunks that changed, one that fails is flagged again
+        // so it is sent again with the next update
+        for (uint8_t chunk = 0; chunk < 12; chunk++) {
+            if (g_pwm_buffer_update_required[0] & (1 << chunk)) {
+                // clear the flag before copying, so a change made while the chunk
+                // is being sent flags it again
+                ISSI_UPDATE_FLAGS_ATOMIC { g_pwm_buffer_update_required[0] &= ~(1 << chunk); }
+                if (!IS31FL3736_write_pwm_chunk(addr1, g_pwm_buffer[0], chunk)) {
+                    ISSI_UPDATE_FLAGS_ATOMIC { g_pwm_buffer_update_required[0] |= 1 << chunk; }
+                }
+            }
+        }
         // IS31FL3736_write_pwm_buffer(addr2, g_pwm_buffer[1]);
     }
-    g_pwm_buffer_update_required = false;
 }
 
 void IS31FL3736_update_led_control_registers(uint8_t addr1, uint8_t addr2) {
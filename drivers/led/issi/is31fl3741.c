@@ -24,6 +24,14 @@
 #include "i2c_master.h"
 #include "progmem.h"
 
+#ifdef RGB_MATRIX_ASYNC_FLUSH
+#    include "atomic_util.h"
+// The rgb_flush thread clears the update flags while the main thread sets them
+#    define ISSI_UPDATE_FLAGS_ATOMIC ATOMIC_BLOCK_FORCEON
+#else
+#    define ISSI_UPDATE_FLAGS_ATOMIC
+#endif
+
 // This is a 7-bit address, that gets left-shifted and bit 0
 // set to 0 for write, 1 for read (as per I2C protocol)
 // The address will vary depending on your wiring:
@@ -63,6 +71,9 @@
 
 #define ISSI_MAX_LEDS 351
 
+// The PWM registers are transferred in chunks of 18 bytes, the last one holding the 9 left
+#define ISSI_PWM_CHUNKS 20
+
 // Transfer buffer for TWITransmitData()
 uint8_t g_twi_transfer_buffer[20] = {0xFF};
 
@@ -72,70 +83,79 @@ uint8_t g_twi_transfer_buffer[20] = {0xFF};
 // We could optimize this and take out the unused registers from these
 // buffers and the transfers in IS31FL3741_write_pwm_buffer() but it's
 // probably not worth the extra complexity.
-uint8_t g_pwm_buffer[DRIVER_COUNT][ISSI_MAX_LEDS];
-bool    g_pwm_buffer_update_required                      = false;
-bool    g_scaling_registers_update_required[DRIVER_COUNT] = {false};
+// Each bit of the PWM update flags marks a chunk that changed since it
+// was last transferred, so the other chunks still match the PWM registers.
+uint8_t  g_pwm_buffer[DRIVER_COUNT][ISSI_MAX_LEDS];
+uint32_t g_pwm_buffer_update_required[DRIVER_COUNT]        = {0};
+bool     g_scaling_registers_update_required[DRIVER_COUNT] = {false};
 
 uint8_t g_scaling_registers[DRIVER_COUNT][ISSI_MAX_LEDS];
 
-void IS31FL3741_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
+bool IS31FL3741_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
+    // if the transaction fails function returns false
     g_twi_transfer_buffer[0] = reg;
     g_twi_transfer_buffer[1] = data;
 
 #if ISSI_PERSISTENCE > 0
     for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 2, ISSI_TIMEOUT) == 0) break;
+        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 2, ISSI_TIMEOUT) == 0) return true;
     }
+    return false;
 #else
-    i2c_transmit(addr << 1, g_twi_transfer_buffer, 2, ISSI_TIMEOUT);
+    return i2c_transmit(addr << 1, g_twi_transfer_buffer, 2, ISSI_TIMEOUT) == 0;
 #endif
 }
 
-bool IS31FL3741_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
-    // unlock the command register and select PG2
-    IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
-    IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM0);
+static bool IS31FL3741_write_pwm_chunks(uint8_t addr, uint8_t *pwm_buffer, uint32_t *chunks) {
+    // transmit the flagged chunks of PWM registers, clearing the flag of each one that's sent
+    // chunks 0-9 are on PG0, chunks 10-19 on PG1
+    // if any of the transactions fails function returns false, leaving the remaining chunks flagged
+    uint8_t page = 0xFF;
+
+    for (uint8_t chunk = 0; chunk < ISSI_PWM_CHUNKS; chunk++) {
+        if (!(*chunks & (1UL << chunk))) {
+            continue;
+        }
 
-    for (int i = 0; i < 342; i += 18) {
-        if (i == 180) {
-            // unlock the command register and select PG2
-            IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
-            IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM1);
+        uint16_t i = chunk * 18;
+        if (page != i / 180) {
+            // unlock the command register and select PG0 or PG1
+            if (!IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5) || !IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER, i < 180 ? ISSI_PAGE_PWM0 : ISSI_PAGE_PWM1)) {
+                return false;
+            }
+            page = i / 180;
         }
 
+        // clear the flag before copying, so a change made while the chunk is being sent flags it again
+        ISSI_UPDATE_FLAGS_ATOMIC { *chunks &= ~(1UL << chunk); }
+
+        // the last chunk only has the 9 left, as the total number is 351
+        uint8_t length           = chunk == ISSI_PWM_CHUNKS - 1 ? ISSI_MAX_LEDS - i : 18;
         g_twi_transfer_buffer[0] = i % 180;
-        memcpy(g_twi_transfer_buffer + 1, pwm_buffer + i, 18);
+        memcpy(g_twi_transfer_buffer + 1, pwm_buffer + i, length);
 
 #if ISSI_PERSISTENCE > 0
         for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 19, ISSI_TIMEOUT) != 0) {
+            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, length + 1, ISSI_TIMEOUT) != 0) {
+                ISSI_UPDATE_FLAGS_ATOMIC { *chunks |= 1UL << chunk; }
                 return false;
             }
         }
 #else
-        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 19, ISSI_TIMEOUT) != 0) {
+        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, length + 1, ISSI_TIMEOUT) != 0) {
+            ISSI_UPDATE_FLAGS_ATOMIC { *chunks |= 1UL << chunk; }
             return false;
         }
 #endif
     }
 
-    // transfer the left cause the total number is 351
-    g_twi_transfer_buffer[0] = 162;
-    memcpy(g_twi_transfer_buffer + 1, pwm_buffer + 342, 9);
+    return true;
+}
 
-#if ISSI_PERSISTENCE > 0
-    for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 10, ISSI_TIMEOUT) != 0) {
-            return false;
-        }
-    }
-#else
-    if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 10, ISSI_TIMEOUT) != 0) {
-        return false;
-    }
-#endif
+bool IS31FL3741_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+    uint32_t chunks = (1UL << ISSI_PWM_CHUNKS) - 1;
 
-    return true;
+    return IS31FL3741_write_pwm_chunks(addr, pwm_buffer, &chunks);
 }
 
 void IS31FL3741_init(uint8_t addr) {
@@ -165,14 +185,21 @@ void IS31FL3741_init(uint8_t addr) {
     wait_ms(10);
 }
 
+static void IS31FL3741_set_pwm_register(uint8_t driver, uint16_t reg, uint8_t value) {
+    // only a changed value needs its chunk sent again
+    if (g_pwm_buffer[driver][reg] != value) {
+        g_pwm_buffer[driver][reg] = value;
+        ISSI_UPDATE_FLAGS_ATOMIC { g_pwm_buffer_update_required[driver] |= 1UL << (reg / 18); }
+    }
+}
+
 void IS31FL3741_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     if (index >= 0 && index < DRIVER_LED_TOTAL) {
         is31_led led = g_is31_leds[index];
 
-        g_pwm_buffer[led.driver][led.r] = red;
-        g_pwm_buffer[led.driver][led.g] = green;
-        g_pwm_buffer[led.driver][led.b] = blue;
-        g_pwm_buffer_update_required    = true;
+        IS31FL3741_set_pwm_register(led.driver, led.r, red);
+        IS31FL3741_set_pwm_register(led.driver, led.g, green);
+        IS31FL3741_set_pwm_register(led.driver, led.b, blue);
     }
 }
 
@@ -207,19 +234,16 @@ void IS31FL3741_set_led_control_register(uint8_t index, bool red, bool green, bo
 }
 
 void IS31FL3741_update_pwm_buffers(uint8_t addr1, uint8_t addr2) {
-    if (g_pwm_buffer_update_required) {
-        IS31FL3741_write_pwm_buffer(addr1, g_pwm_buffer[0]);
+    // only transfer the chunks that changed, the ones that fail are sent again with the next update
+    if (g_pwm_buffer_update_required[0]) {
+        IS31FL3741_write_pwm_chunks(addr1, g_pwm_buffer[0], &g_pwm_buffer_update_required[0]);
     }
-
-    g_pwm_buffer_update_required = false;
 }
 
 void IS31FL3741_set_pwm_buffer(const is31_led *pled, uint8_t red, uint8_t green, uint8_t blue) {
-    g_pwm_buffer[pled->driver][pled->r] = red;
-    g_pwm_buffer[pled->driver][pled->g] = green;
-    g_pwm_buffer[pled->driver][pled->b] = blue;
-
-    g_pwm_buffer_update_required = true;
+    IS31FL3741_set_pwm_register(pled->driver, pled->r, red);
+    IS31FL3741_set_pwm_register(pled->driver, pled->g, green);
+    IS31FL3741_set_pwm_register(pled->driver, pled->b, blue);
 }
 
 void IS31FL3741_update_led_control_registers(uint8_t addr, uint8_t index) {
@@ -6,34 +6,79 @@
 #include "ws2812.h"
 #include "ws2812.pio.h"
 
-#include "atomic_util.h"
 #include "pio_manager.h"
 #include "boards/pico_boards.h"
 
 #include "pico/stdlib.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
 
 #ifndef WS2812_RES
 #    define WS2812_RES (1000 * WS2812_TRST_US)
 #endif
 
-static PIO pio = pio0;
-static int sm  = 0;
+// Time to shift out one LED at 800kHz, in us
+#define WS2812_LED_TIME_US 30
+
+static PIO pio      = pio0;
+static int sm       = 0;
+static int dma_chan = -1;
+
+// Words fed to the state machine by DMA, only the LEDs that changed are written
+static uint32_t ws2812_buffer[RGBLED_NUM];
+// The LEDs may still show whatever was set before a reset, so the first frame is always sent
+static bool ws2812_first_frame = true;
+// Set while the last frame is still being shifted out or latched
+static bool ws2812_frame_pending = false;
+// time_us_32() when the last frame was started, and how long it takes until it's latched
+static uint32_t ws2812_frame_start;
+static uint32_t ws2812_frame_time;
+
+__attribute__((weak)) void ws2812_transfer_complete_callback(void) {}
+
+static void ws2812_dma_handler(void) {
+    if (dma_channel_get_irq0_status(dma_chan)) {
+        dma_channel_acknowledge_irq0(dma_chan);
+        ws2812_transfer_complete_callback();
+    }
+}
 
 static int ws2812_init(void) {
+    // Claimed first: the init is retried on every frame until it succeeds, and the PIO
+    // state machine and program are only claimed once nothing else can fail
+    dma_chan = dma_claim_unused_channel(false);
+
+    if (dma_chan < 0) {
+        return -1;
+    }
+
     sm = pio_manager_get_empty_sm(pio);
 
     if (sm < 0) {
+        dma_channel_unclaim(dma_chan);
         return -1;
     }
 
     int32_t offset = pio_manager_add_program(pio, sm, &ws2812_program);
 
     if (offset < 0) {
+        dma_channel_unclaim(dma_chan);
         return -1;
     }
 
     ws2812_program_init(pio, sm, offset, RGB_DI_PIN, 800000, false);
 
+    dma_channel_config config = dma_channel_get_default_config(dma_chan);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_32);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, pio_get_dreq(pio, sm, true));
+    dma_channel_configure(dma_chan, &config, &pio->txf[sm], ws2812_buffer, 0, false);
+
+    dma_channel_set_irq0_enabled(dma_chan, true);
+    irq_add_shared_handler(DMA_IRQ_0, ws2812_dma_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+
     return 0;
 }
 
@@ -47,19 +92,36 @@ void ws2812_setleds(LED_TYPE *ledarray, uint16_t number_of_leds) {
         }
     }
 
-    __interrupt_disable__();
+    if (number_of_leds > RGBLED_NUM) {
+        number_of_leds = RGBLED_NUM;
+    }
 
-    for (int i = 0; i < number_of_leds; i++) {
-        pio_sm_put_blocking(pio, sm,
-                            (((uint32_t)ledarray[i].r) << 16) |
-                                (((uint32_t)ledarray[i].g) << 24) |
-                                ((uint32_t)ledarray[i].b << 8));
+    // The previous frame is read straight from ws2812_buffer, so wait until it is out
+    // The elapsed time is only compared while a frame is pending, so it doesn't matter how long
+    // ago the last frame was sent when nothing changed since
+    while (dma_channel_is_busy(dma_chan) || (ws2812_frame_pending && time_us_32() - ws2812_frame_start < ws2812_frame_time)) {
+        continue;
     }
+    ws2812_frame_pending = false;
 
-    __interrupt_enable__(NULL);
+    bool changed       = ws2812_first_frame;
+    ws2812_first_frame = false;
+    for (int i = 0; i < number_of_leds; i++) {
+        uint32_t word = (((uint32_t)ledarray[i].r) << 16) |
+                        (((uint32_t)ledarray[i].g) << 24) |
+                        ((uint32_t)ledarray[i].b << 8);
+        if (ws2812_buffer[i] != word) {
+            ws2812_buffer[i] = word;
+            changed          = true;
+        }
+    }
 
-    while (!pio_sm_is_tx_fifo_empty(pio, sm)) {
-        continue;
+    if (!changed) {
+        return;
     }
-    busy_wait_us(WS2812_RES / 1000);
+
+    dma_channel_transfer_from_buffer_now(dma_chan, ws2812_buffer, number_of_leds);
+    ws2812_frame_start   = time_us_32();
+    ws2812_frame_time    = number_of_leds * WS2812_LED_TIME_US + WS2812_RES / 1000;
+    ws2812_frame_pending = true;
 }
@@ -38,3 +38,11 @@
  *         - Wait 50us to reset the LEDs
  */
 void ws2812_setleds(LED_TYPE *ledarray, uint16_t number_of_leds);
+
+/* Completion callback
+ *
+ * Drivers that send the LED data in the background (SPI without the circular
+ * buffer, and RP2040) return from ws2812_setleds() as soon as the transfer
+ * has started, and call this from interrupt context once it has completed.
+ */
+void ws2812_transfer_complete_callback(void);
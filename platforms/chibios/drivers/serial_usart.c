@@ -39,6 +39,13 @@ static inline bool __attribute__((nonnull)) send(const uint8_t* source, const si
 static inline int  initiate_transaction(uint8_t sstd_index);
 static inline void usart_clear(void);
 
+#if defined(SERIAL_USART_PIPELINE)
+/* Handshakes expected back for write-only transactions still in flight, oldest first. */
+static uint8_t pipeline_handshakes[SERIAL_USART_PIPELINE_DEPTH];
+static uint8_t pipeline_head  = 0;
+static uint8_t pipeline_count = 0;
+#endif
+
 /**
  * @brief Clear the receive input queue.
  */
@@ -205,10 +212,12 @@ static inline bool react_to_transactions(void) {
     /* Send back the handshake which is XORed as a simple checksum,
      to signal that the slave is ready to receive possible transaction buffers  */
     sstd_index ^= HANDSHAKE_MAGIC;
+#if !defined(SERIAL_USART_PIPELINE)
     if (!send(&sstd_index, sizeof(sstd_index))) {
         *trans->status = TRANSACTION_DATA_ERROR;
         return false;
     }
+#endif
 
     /* Receive transaction buffer from the master. If this transaction requires it.*/
     if (trans->initiator2target_buffer_size) {
@@ -223,6 +232,14 @@ static inline bool react_to_transactions(void) {
         trans->slave_callback(trans->initiator2target_buffer_size, split_trans_initiator2target_buffer(trans), trans->initiator2target_buffer_size, split_trans_target2initiator_buffer(trans));
     }
 
+#if defined(SERIAL_USART_PIPELINE)
+    /* The master didn't wait for the handshake before sending its buffer, it gets it together with ours. */
+    if (!send(&sstd_index, sizeof(sstd_index))) {
+        *trans->status = TRANSACTION_DATA_ERROR;
+        return false;
+    }
+#endif
+
     /* Send transaction buffer to the master. If this transaction requires it. */
     if (trans->target2initiator_buffer_size) {
         if (!send(split_trans_target2initiator_buffer(trans), trans->target2initiator_buffer_size)) {
@@ -257,12 +274,114 @@ void soft_serial_initiator_init(void) {
  *             TRANSACTION_END in case of success.
  */
 int soft_serial_transaction(int index) {
+#if !defined(SERIAL_USART_PIPELINE)
     /* Clear the receive queue, to start with a clean slate.
      * Parts of failed transactions or spurious bytes could still be in it. */
     usart_clear();
+#endif
     return initiate_transaction((uint8_t)index);
 }
 
+#if defined(SERIAL_USART_PIPELINE)
+
+/**
+ * @brief Forget all transactions in flight and anything received for them.
+ */
+static inline void pipeline_reset(void) {
+    pipeline_head  = 0;
+    pipeline_count = 0;
+    usart_clear();
+}
+
+/**
+ * @brief Wait for the handshakes of earlier write-only transactions, until at most keep are left in flight.
+ *
+ * @return true All handshakes received were correct.
+ * @return false A handshake was wrong or missing, the pipeline has been reset.
+ */
+static inline bool pipeline_flush(uint8_t keep) {
+    while (pipeline_count > keep) {
+        uint8_t sstd_index_shake = 0xFF;
+        if (!receive(&sstd_index_shake, sizeof(sstd_index_shake)) || (sstd_index_shake != pipeline_handshakes[pipeline_head])) {
+            pipeline_reset();
+            return false;
+        }
+        pipeline_head = (pipeline_head + 1) % SERIAL_USART_PIPELINE_DEPTH;
+        pipeline_count--;
+    }
+    return true;
+}
+
+/**
+ * @brief Initiate transaction to slave half, without waiting for the handshake.
+ *
+ * The transaction table index and the transaction buffer are sent in one go. Write-only
+ * transactions return as soon as they are queued for sending; their handshakes are checked
+ * when the pipeline is full or before the next transaction that reads data back, which also
+ * reports a failure of any of them.
+ */
+static inline int initiate_transaction(uint8_t sstd_index) {
+    /* Sanity check that we are actually starting a valid transaction. */
+    if (sstd_index >= NUM_TOTAL_TRANSACTIONS) {
+        dprintln("USART: Illegal transaction Id.");
+        return TRANSACTION_TYPE_ERROR;
+    }
+
+    split_transaction_desc_t* trans = &split_transaction_table[sstd_index];
+
+    /* Transaction is not registered. Abort. */
+    if (!trans->status) {
+        dprintln("USART: Transaction not registered.");
+        return TRANSACTION_TYPE_ERROR;
+    }
+
+    bool write_only = !trans->target2initiator_buffer_size;
+
+    /* Reading data back needs every earlier handshake out of the way, writing only a free slot. */
+    if (!pipeline_flush(write_only ? SERIAL_USART_PIPELINE_DEPTH - 1 : 0)) {
+        dprintln("USART: Handshake failed.");
+        return TRANSACTION_NO_RESPONSE;
+    }
+
+    if (!pipeline_count) {
+        /* Clear the receive queue, to start with a clean slate.
+         * Parts of failed transactions or spurious bytes could still be in it. */
+        usart_clear();
+    }
+
+    /* Send transaction table index to the slave, followed by the transaction buffer if this transaction requires it. */
+    if (!send(&sstd_index, sizeof(sstd_index)) || (trans->initiator2target_buffer_size && !send(split_trans_initiator2target_buffer(trans), trans->initiator2target_buffer_size))) {
+        dprintln("USART: Send failed.");
+        pipeline_reset();
+        return TRANSACTION_NO_RESPONSE;
+    }
+
+    if (write_only) {
+        pipeline_handshakes[(pipeline_head + pipeline_count) % SERIAL_USART_PIPELINE_DEPTH] = sstd_index ^ HANDSHAKE_MAGIC;
+        pipeline_count++;
+        return TRANSACTION_END;
+    }
+
+    uint8_t sstd_index_shake = 0xFF;
+
+    /* The slave answers with the handshake, followed by its transaction buffer. */
+    if (!receive(&sstd_index_shake, sizeof(sstd_index_shake)) || (sstd_index_shake != (sstd_index ^ HANDSHAKE_MAGIC))) {
+        dprintln("USART: Handshake failed.");
+        pipeline_reset();
+        return TRANSACTION_NO_RESPONSE;
+    }
+
+    if (!receive(split_trans_target2initiator_buffer(trans), trans->target2initiator_buffer_size)) {
+        dprintln("USART: Receive failed.");
+        pipeline_reset();
+        return TRANSACTION_NO_RESPONSE;
+    }
+
+    return TRANSACTION_END;
+}
+
+#else
+
 /**
  * @brief Initiate transaction to slave half.
  */
@@ -316,3 +435,5 @@ static inline int initiate_transaction(uint8_t sstd_index) {
 
     return TRANSACTION_END;
 }
+
+#endif
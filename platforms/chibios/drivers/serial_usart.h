@@ -113,4 +113,13 @@
 #    define SERIAL_USART_TIMEOUT 20
 #endif
 
+#if defined(SERIAL_USART_PIPELINE)
+#    if !defined(SERIAL_USART_FULL_DUPLEX)
+#        error "SERIAL_USART_PIPELINE requires SERIAL_USART_FULL_DUPLEX"
+#    endif
+#    if !defined(SERIAL_USART_PIPELINE_DEPTH)
+#        define SERIAL_USART_PIPELINE_DEPTH 8
+#    endif
+#endif
+
 #define HANDSHAKE_MAGIC 7
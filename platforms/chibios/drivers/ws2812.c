@@ -51,7 +51,9 @@
 
 // The reset gap can be 6000 ns, but depending on the LED strip it may have to be increased
 // to values like 600000 ns. If it is too small, the pixels will show nothing most of the time.
-#define RES (1000 * WS2812_TRST_US)  // Width of the low gap between bits to cause a frame to latch
+// The gap is not waited out with interrupts disabled, instead the next frame is held back until
+// it has elapsed. One extra tick covers the partial tick the end of the previous frame fell into.
+#define RES_TICKS (TIME_US2I(WS2812_TRST_US) + 1)  // Width of the low gap between bits to cause a frame to latch
 
 void sendByte(uint8_t byte) {
     // WS2812 protocol wants most significant bits first
@@ -74,6 +76,8 @@ void sendByte(uint8_t byte) {
     }
 }
 
+static systime_t last_frame_end;
+
 void ws2812_init(void) { palSetLineMode(RGB_DI_PIN, WS2812_OUTPUT_MODE); }
 
 // Setleds for standard RGB
@@ -82,12 +86,22 @@ void ws2812_setleds(LED_TYPE *ledarray, uint16_t leds) {
     if (!s_init) {
         ws2812_init();
         s_init = true;
+    } else {
+        while (chVTTimeElapsedSinceX(last_frame_end) < RES_TICKS) {
+            chThdYield();
+        }
     }
 
     // this code is very time dependent, so we need to disable interrupts
+    // WS2812_BITBANG_INTERRUPTIBLE only does so while a single LED is sent
+#ifndef WS2812_BITBANG_INTERRUPTIBLE
     chSysLock();
+#endif
 
     for (uint8_t i = 0; i < leds; i++) {
+#ifdef WS2812_BITBANG_INTERRUPTIBLE
+        chSysLock();
+#endif
         // WS2812 protocol dictates grb order
 #if (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_GRB)
         sendByte(ledarray[i].g);
@@ -105,10 +119,15 @@ void ws2812_setleds(LED_TYPE *ledarray, uint16_t leds) {
 
 #ifdef RGBW
         sendByte(ledarray[i].w);
+#endif
+#ifdef WS2812_BITBANG_INTERRUPTIBLE
+        chSysUnlock();
 #endif
     }
 
-    wait_ns(RES);
-
+#ifndef WS2812_BITBANG_INTERRUPTIBLE
     chSysUnlock();
+#endif
+
+    last_frame_end = chVTGetSystemTimeX();
 }
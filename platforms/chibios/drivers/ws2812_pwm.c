@@ -1,3 +1,4 @@
+#include <string.h>
 #include "ws2812.h"
 #include "quantum.h"
 #include <hal.h>
@@ -231,6 +232,7 @@
 /* --- PRIVATE VARIABLES ---------------------------------------------------- */
 
 static uint32_t ws2812_frame_buffer[WS2812_BIT_N + 1]; /**< Buffer for a frame */
+static LED_TYPE ws2812_leds[RGBLED_NUM];               /**< Colors encoded in the frame buffer, all off after init */
 
 /* --- PUBLIC FUNCTIONS ----------------------------------------------------- */
 /*
@@ -305,7 +307,11 @@ void ws2812_setleds(LED_TYPE* ledarray, uint16_t leds) {
         s_init = true;
     }
 
+    // The DMA keeps streaming the frame buffer, so only the LEDs that changed need encoding
     for (uint16_t i = 0; i < leds; i++) {
-        ws2812_write_led(i, ledarray[i].r, ledarray[i].g, ledarray[i].b);
+        if (memcmp(&ws2812_leds[i], &ledarray[i], sizeof(LED_TYPE)) != 0) {
+            ws2812_leds[i] = ledarray[i];
+            ws2812_write_led(i, ledarray[i].r, ledarray[i].g, ledarray[i].b);
+        }
     }
 }
@@ -1,3 +1,4 @@
+#include <string.h>
 #include "quantum.h"
 #include "ws2812.h"
 
@@ -82,6 +83,11 @@
 
 static uint8_t txbuf[PREAMBLE_SIZE + DATA_SIZE + RESET_SIZE] = {0};
 
+// Colors encoded in txbuf, so that only the LEDs that changed are encoded again
+static LED_TYPE ws2812_leds[RGBLED_NUM];
+// The LEDs may still show whatever was set before a reset, so the first frame is always sent
+static bool ws2812_first_frame = true;
+
 /*
  * As the trick here is to use the SPI to send a huge pattern of 0 and 1 to
  * the ws2812b protocol, we use this helper function to translate bytes into
@@ -118,6 +124,15 @@ static void set_led_color_rgb(LED_TYPE color, int pos) {
 #endif
 }
 
+__attribute__((weak)) void ws2812_transfer_complete_callback(void) {}
+
+#ifndef WS2812_SPI_USE_CIRCULAR_BUFFER
+static void ws2812_spi_end_cb(SPIDriver* spip) { ws2812_transfer_complete_callback(); }
+#    define WS2812_SPI_END_CB ws2812_spi_end_cb
+#else
+#    define WS2812_SPI_END_CB NULL
+#endif
+
 void ws2812_init(void) {
     palSetLineMode(RGB_DI_PIN, WS2812_MOSI_OUTPUT_MODE);
 
@@ -125,8 +140,13 @@ void ws2812_init(void) {
     palSetLineMode(WS2812_SPI_SCK_PIN, WS2812_SCK_OUTPUT_MODE);
 #endif  // WS2812_SPI_SCK_PIN
 
+    // Start out with every LED off, which is what ws2812_leds holds
+    for (int i = 0; i < RGBLED_NUM; i++) {
+        set_led_color_rgb(ws2812_leds[i], i);
+    }
+
     // TODO: more dynamic baudrate
-    static const SPIConfig spicfg = {WS2812_SPI_BUFFER_MODE, NULL, PAL_PORT(RGB_DI_PIN), PAL_PAD(RGB_DI_PIN), WS2812_SPI_DIVISOR_CR1_BR_X};
+    static const SPIConfig spicfg = {WS2812_SPI_BUFFER_MODE, WS2812_SPI_END_CB, PAL_PORT(RGB_DI_PIN), PAL_PAD(RGB_DI_PIN), WS2812_SPI_DIVISOR_CR1_BR_X};
 
     spiAcquireBus(&WS2812_SPI);     /* Acquire ownership of the bus.    */
     spiStart(&WS2812_SPI, &spicfg); /* Setup transfer parameters.       */
@@ -143,11 +163,29 @@ void ws2812_setleds(LED_TYPE* ledarray, uint16_t leds) {
         s_init = true;
     }
 
+#if !defined(WS2812_SPI_USE_CIRCULAR_BUFFER) && !defined(WS2812_SPI_SYNC)
+    // The previous frame is still being sent, each led takes ~0.03ms, 50 leds ~1.5ms.
+    // Only animations flushing faster than that end up waiting here.
+    while (WS2812_SPI.state == SPI_ACTIVE) {
+        chThdYield();
+    }
+#endif
+
+    bool changed       = ws2812_first_frame;
+    ws2812_first_frame = false;
     for (uint8_t i = 0; i < leds; i++) {
-        set_led_color_rgb(ledarray[i], i);
+        if (memcmp(&ws2812_leds[i], &ledarray[i], sizeof(LED_TYPE)) != 0) {
+            ws2812_leds[i] = ledarray[i];
+            set_led_color_rgb(ledarray[i], i);
+            changed = true;
+        }
+    }
+
+    if (!changed) {
+        return;
     }
 
-    // Send async - each led takes ~0.03ms, 50 leds ~1.5ms, animations flushing faster than send will cause issues.
+    // Send async, ws2812_transfer_complete_callback() is called once done.
     // Instead spiSend can be used to send synchronously (or the thread logic can be added back).
 #ifndef WS2812_SPI_USE_CIRCULAR_BUFFER
 #    ifdef WS2812_SPI_SYNC
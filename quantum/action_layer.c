@@ -1,8 +1,10 @@
 #include <stdint.h>
+#include <string.h>
 #include "keyboard.h"
 #include "action.h"
 #include "util.h"
 #include "action_layer.h"
+#include "keycode_config.h"
 
 #ifdef DEBUG_ACTION
 #    include "debug.h"
@@ -181,7 +183,97 @@ void layer_xor(layer_state_t state) { layer_state_set(layer_state ^ state); }
 void layer_debug(void) { dprintf("%08lX(%u)", layer_state, get_highest_layer(layer_state)); }
 #endif
 
+#ifndef NO_ACTION_LAYER
+/** \brief Layer switch resolve
+ *
+ * Walks the given layers from the top and returns the first one where the key
+ * isn't transparent, storing the action found there.
+ */
+static uint8_t layer_switch_resolve(layer_state_t layers, keypos_t key, action_t *action) {
+    /* check top layer first */
+    for (int8_t i = MAX_LAYER - 1; i >= 0; i--) {
+        if (layers & ((layer_state_t)1 << i)) {
+            *action = action_for_key(i, key);
+            if (action->code != ACTION_TRANSPARENT) {
+                return i;
+            }
+        }
+    }
+    /* fall back to layer 0 */
+    *action = action_for_key(0, key);
+    return 0;
+}
+#endif
+
+#if !defined(NO_ACTION_LAYER) && defined(LAYER_ACTION_CACHE)
+/** \brief layer action cache
+ *
+ * Topmost non-transparent layer and its action for every key. Entries are
+ * resolved on first use and dropped when the active layers, the keymap
+ * config or the keymap itself change.
+ */
+typedef struct {
+    action_t action;
+    uint8_t  layer;
+#    ifndef STRICT_LAYER_RELEASE
+    uint8_t source_layer;
+#    endif
+} layer_cache_entry_t;
+
+static layer_cache_entry_t layer_cache[MATRIX_ROWS * MATRIX_COLS];
+static uint8_t             layer_cache_valid[(MATRIX_ROWS * MATRIX_COLS + 7) / 8] = {0};
+static layer_state_t       layer_cache_layers                                       = 0;
+static uint16_t            layer_cache_keymap_config                                = 0;
+
+/** \brief layer cache invalidate
+ *
+ * Drops every resolved action, needs to be called after changing the keymap
+ */
+void layer_cache_invalidate(void) { memset(layer_cache_valid, 0, sizeof(layer_cache_valid)); }
+
+/** \brief layer cache get
+ *
+ * Returns the cache entry for the key, resolving it first if needed
+ */
+static layer_cache_entry_t *layer_cache_get(keypos_t key) {
+    const uint16_t key_number = key.col + (key.row * MATRIX_COLS);
+    layer_state_t  layers     = layer_state | default_layer_state;
+
+    if (layers != layer_cache_layers || keymap_config.raw != layer_cache_keymap_config) {
+        layer_cache_invalidate();
+        layer_cache_layers        = layers;
+        layer_cache_keymap_config = keymap_config.raw;
+    }
+
+    layer_cache_entry_t *entry = &layer_cache[key_number];
+    if (!(layer_cache_valid[key_number / 8] & (1U << (key_number % 8)))) {
+        entry->layer = layer_switch_resolve(layers, key, &entry->action);
+        layer_cache_valid[key_number / 8] |= (1U << (key_number % 8));
+    }
+    return entry;
+}
+
+static inline bool layer_cache_has_key(keypos_t key) { return key.row < MATRIX_ROWS && key.col < MATRIX_COLS; }
+#endif
+
 #if !defined(NO_ACTION_LAYER) && !defined(STRICT_LAYER_RELEASE)
+#    ifdef LAYER_ACTION_CACHE
+/** \brief update source layers cache
+ *
+ * Updates the cached keys when changing layers
+ */
+void update_source_layers_cache(keypos_t key, uint8_t layer) {
+    if (layer_cache_has_key(key)) {
+        layer_cache[key.col + (key.row * MATRIX_COLS)].source_layer = layer;
+    }
+}
+
+/** \brief read source layers cache
+ *
+ * reads the cached keys stored when the layer was changed
+ */
+uint8_t read_source_layers_cache(keypos_t key) { return layer_cache_has_key(key) ? layer_cache[key.col + (key.row * MATRIX_COLS)].source_layer : 0; }
+#    else
 /** \brief source layer cache
  */
 
@@ -217,6 +309,7 @@ uint8_t read_source_layers_cache(keypos_t key) {
 
     return layer;
 }
+#    endif
 #endif
 
 /** \brief Store or get action (FIXME: Needs better summary)
@@ -234,6 +327,20 @@ action_t store_or_get_action(bool pressed, keypos_t key) {
 
     uint8_t layer;
 
+#    ifdef LAYER_ACTION_CACHE
+    if (layer_cache_has_key(key)) {
+        layer_cache_entry_t *entry = layer_cache_get(key);
+        if (pressed) {
+            entry->source_layer = entry->layer;
+            return entry->action;
+        }
+        // the key was pressed on the layer it still resolves to
+        if (entry->source_layer == entry->layer) {
+            return entry->action;
+        }
+        return action_for_key(entry->source_layer, key);
+    }
+#    endif
     if (pressed) {
         layer = layer_switch_get_layer(key);
         update_source_layers_cache(key, layer);
@@ -252,21 +359,13 @@ action_t store_or_get_action(bool pressed, keypos_t key) {
  */
 uint8_t layer_switch_get_layer(keypos_t key) {
 #ifndef NO_ACTION_LAYER
-    action_t action;
-    action.code = ACTION_TRANSPARENT;
-
-    layer_state_t layers = layer_state | default_layer_state;
-    /* check top layer first */
-    for (int8_t i = MAX_LAYER - 1; i >= 0; i--) {
-        if (layers & ((layer_state_t)1 << i)) {
-            action = action_for_key(i, key);
-            if (action.code != ACTION_TRANSPARENT) {
-                return i;
-            }
-        }
+#    ifdef LAYER_ACTION_CACHE
+    if (layer_cache_has_key(key)) {
+        return layer_cache_get(key)->layer;
     }
-    /* fall back to layer 0 */
-    return 0;
+#    endif
+    action_t action;
+    return layer_switch_resolve(layer_state | default_layer_state, key, &action);
 #else
     return get_highest_layer(default_layer_state);
 #endif
@@ -276,4 +375,17 @@ uint8_t layer_switch_get_layer(keypos_t key) {
  *
  * Gets action code based on key position
  */
-action_t layer_switch_get_action(keypos_t key) { return action_for_key(layer_switch_get_layer(key), key); }
+action_t layer_switch_get_action(keypos_t key) {
+#ifndef NO_ACTION_LAYER
+#    ifdef LAYER_ACTION_CACHE
+    if (layer_cache_has_key(key)) {
+        return layer_cache_get(key)->action;
+    }
+#    endif
+    action_t action;
+    layer_switch_resolve(layer_state | default_layer_state, key, &action);
+    return action;
+#else
+    return action_for_key(layer_switch_get_layer(key), key);
+#endif
+}
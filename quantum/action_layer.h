@@ -132,6 +132,13 @@ layer_state_t layer_state_set_kb(layer_state_t state);
 #    define layer_state_set_user(state) (void)state
 #endif
 
+/* resolved actions cache */
+#if !defined(NO_ACTION_LAYER) && defined(LAYER_ACTION_CACHE)
+void layer_cache_invalidate(void);
+#else
+#    define layer_cache_invalidate()
+#endif
+
 /* pressed actions cache */
 #if !defined(NO_ACTION_LAYER) && !defined(STRICT_LAYER_RELEASE)
 
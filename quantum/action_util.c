@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "action_layer.h"
 #include "timer.h"
 #include "keycode_config.h"
+#include <string.h>
 
 extern keymap_config_t keymap_config;
 
@@ -46,9 +47,117 @@ static int8_t cb_count = 0;
 // report_keyboard_t keyboard_report = {};
 report_keyboard_t *keyboard_report = &(report_keyboard_t){};
 
+#ifdef KEYBOARD_REPORT_TRACKING
+#    ifdef USB_6KRO_ENABLE
+#        error KEYBOARD_REPORT_TRACKING does not support USB_6KRO_ENABLE
+#    endif
+
+/* Keys in keyboard_report are tracked as they are added and removed, so that
+ * adding, removing and checking a key never walks the report, and
+ * send_keyboard_report() can skip reports that would repeat the last one sent.
+ * In NKRO mode the report's own bitmap tells which keys are present.
+ */
+static uint8_t        keyboard_report_bitmap[32];  // 6KRO: keys present in keyboard_report->keys
+static uint8_t        keyboard_report_key_count = 0;
+static bool           keyboard_report_dirty     = true;
+static bool           keyboard_report_nkro      = false;
+static uint8_t        keyboard_report_sent_mods = 0;
+static host_driver_t *keyboard_report_sent_to   = NULL;
+
+static inline bool keyboard_report_is_nkro(void) {
+#    ifdef NKRO_ENABLE
+    return keyboard_protocol && keymap_config.nkro;
+#    else
+    return false;
+#    endif
+}
+
+/** \brief Rebuild the key tracking from keyboard_report after switching between NKRO and 6KRO */
+static void keyboard_report_resync(void) {
+    keyboard_report_nkro      = keyboard_report_is_nkro();
+    keyboard_report_key_count = 0;
+    keyboard_report_dirty     = true;
+    memset(keyboard_report_bitmap, 0, sizeof(keyboard_report_bitmap));
+
+#    ifdef NKRO_ENABLE
+    if (keyboard_report_nkro) {
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_BITS; i++) {
+            for (uint8_t bits = keyboard_report->nkro.bits[i]; bits; bits &= bits - 1) {
+                keyboard_report_key_count++;
+            }
+        }
+        return;
+    }
+#    endif
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        uint8_t key = keyboard_report->keys[i];
+        if (key && !(keyboard_report_bitmap[key >> 3] & (1 << (key & 7)))) {
+            keyboard_report_bitmap[key >> 3] |= 1 << (key & 7);
+            keyboard_report_key_count++;
+        }
+    }
+}
+
+bool keyboard_report_has_key(uint8_t key) {
+    if (keyboard_report_nkro != keyboard_report_is_nkro()) {
+        keyboard_report_resync();
+    }
+#    ifdef NKRO_ENABLE
+    if (keyboard_report_nkro) {
+        return (key >> 3) < KEYBOARD_REPORT_BITS && (keyboard_report->nkro.bits[key >> 3] & (1 << (key & 7)));
+    }
+#    endif
+    return keyboard_report_bitmap[key >> 3] & (1 << (key & 7));
+}
+
+void add_key(uint8_t key) {
+    if (key == KC_NO || keyboard_report_has_key(key)) {
+        return;
+    }
+#    ifdef NKRO_ENABLE
+    if (keyboard_report_nkro) {
+        add_key_bit(keyboard_report, key);
+        if ((key >> 3) < KEYBOARD_REPORT_BITS) {
+            keyboard_report_key_count++;
+            keyboard_report_dirty = true;
+        }
+        return;
+    }
+#    endif
+    if (keyboard_report_key_count < KEYBOARD_REPORT_KEYS) {
+        add_key_byte(keyboard_report, key);
+        keyboard_report_bitmap[key >> 3] |= 1 << (key & 7);
+        keyboard_report_key_count++;
+        keyboard_report_dirty = true;
+    }
+}
+
+void del_key(uint8_t key) {
+    if (key == KC_NO || !keyboard_report_has_key(key)) {
+        return;
+    }
+    del_key_from_report(keyboard_report, key);
+    keyboard_report_bitmap[key >> 3] &= ~(1 << (key & 7));
+    keyboard_report_key_count--;
+    keyboard_report_dirty = true;
+}
+
+void clear_keys(void) {
+    if (keyboard_report_nkro != keyboard_report_is_nkro()) {
+        keyboard_report_resync();
+    }
+    if (keyboard_report_key_count) {
+        clear_keys_from_report(keyboard_report);
+        memset(keyboard_report_bitmap, 0, sizeof(keyboard_report_bitmap));
+        keyboard_report_key_count = 0;
+        keyboard_report_dirty     = true;
+    }
+}
+#else
 extern inline void add_key(uint8_t key);
 extern inline void del_key(uint8_t key);
 extern inline void clear_keys(void);
+#endif
 
 #ifndef NO_ACTION_ONESHOT
 static uint8_t oneshot_mods        = 0;
@@ -225,6 +334,18 @@ bool is_oneshot_enabled(void) { return keymap_config.oneshot_disable; }
 
 #endif
 
+/** \brief Forget the last keyboard report sent
+ *
+ * The next send_keyboard_report() then sends the report even if it is unchanged. Call this when
+ * reports start going to another host without the host driver changing, e.g. when switching
+ * between USB and Bluetooth.
+ */
+void clear_sent_report(void) {
+#ifdef KEYBOARD_REPORT_TRACKING
+    keyboard_report_dirty = true;
+#endif
+}
+
 /** \brief Send keyboard report
  *
  * FIXME: needs doc
@@ -243,7 +364,11 @@ void send_keyboard_report(void) {
         }
 #    endif
         keyboard_report->mods |= oneshot_mods;
+#    ifdef KEYBOARD_REPORT_TRACKING
+        if (keyboard_report_key_count) {
+#    else
         if (has_anykey(keyboard_report)) {
+#    endif
             clear_oneshot_mods();
         }
     }
@@ -256,6 +381,19 @@ void send_keyboard_report(void) {
     keyboard_report->mods |= weak_override_mods;
 #endif
 
+#ifdef KEYBOARD_REPORT_TRACKING
+    // only send when the report differs from the last one sent to this host
+    if (keyboard_report_nkro != keyboard_report_is_nkro()) {
+        keyboard_report_resync();
+    }
+    if (!keyboard_report_dirty && keyboard_report->mods == keyboard_report_sent_mods && host_get_driver() == keyboard_report_sent_to) {
+        return;
+    }
+    keyboard_report_dirty     = false;
+    keyboard_report_sent_mods = keyboard_report->mods;
+    keyboard_report_sent_to   = host_get_driver();
+#endif
+
     host_keyboard_send(keyboard_report);
 }
 
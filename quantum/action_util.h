@@ -27,13 +27,21 @@ extern "C" {
 extern report_keyboard_t *keyboard_report;
 
 void send_keyboard_report(void);
+void clear_sent_report(void);
 
 /* key */
+#ifdef KEYBOARD_REPORT_TRACKING
+void add_key(uint8_t key);
+void del_key(uint8_t key);
+void clear_keys(void);
+bool keyboard_report_has_key(uint8_t key);
+#else
 inline void add_key(uint8_t key) { add_key_to_report(keyboard_report, key); }
 
 inline void del_key(uint8_t key) { del_key_from_report(keyboard_report, key); }
 
 inline void clear_keys(void) { clear_keys_from_report(keyboard_report); }
+#endif
 
 /* modifier */
 uint8_t get_mods(void);
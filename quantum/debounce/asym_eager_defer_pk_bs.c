@@ -0,0 +1,137 @@
+/*
+Copyright 2021 QMK
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+Bit-sliced asymmetric per-key algorithm, equivalent to asym_eager_defer_pk.
+Counters are stored as vertical bit planes (see bitslice.h), so a whole row is updated at once.
+After pressing a key, it immediately changes state, and no further inputs are accepted
+until DEBOUNCE milliseconds have occurred. When a key is released, the change is pushed
+once no state changes have occured for DEBOUNCE milliseconds.
+*/
+
+#include "matrix.h"
+#include "timer.h"
+#include "quantum.h"
+
+#ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#endif
+
+// Maximum debounce: 127ms
+#if DEBOUNCE > 127
+#    undef DEBOUNCE
+#    define DEBOUNCE 127
+#endif
+
+#if DEBOUNCE > 0
+#    include "bitslice.h"
+
+// Direction of the change each running counter is debouncing: set for key-down
+static matrix_row_t debounce_pressed[MATRIX_ROWS];
+static fast_timer_t last_time;
+static bool         counters_need_update;
+static bool         matrix_need_update;
+
+static void update_debounce_counters_and_transfer_if_expired(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, uint8_t elapsed_time);
+static void transfer_matrix_values(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows);
+
+// we use num_rows rather than MATRIX_ROWS to support split keyboards
+void debounce_init(uint8_t num_rows) {
+    bitslice_init();
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        debounce_pressed[row] = 0;
+    }
+    counters_need_update = false;
+    matrix_need_update   = false;
+}
+
+void debounce_free(void) {}
+
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    bool updated_last = false;
+
+    if (counters_need_update) {
+        fast_timer_t now          = timer_read_fast();
+        fast_timer_t elapsed_time = TIMER_DIFF_FAST(now, last_time);
+
+        last_time    = now;
+        updated_last = true;
+        if (elapsed_time > UINT8_MAX) {
+            elapsed_time = UINT8_MAX;
+        }
+
+        if (elapsed_time > 0) {
+            update_debounce_counters_and_transfer_if_expired(raw, cooked, num_rows, elapsed_time);
+        }
+    }
+
+    if (changed || matrix_need_update) {
+        if (!updated_last) {
+            last_time = timer_read_fast();
+        }
+
+        transfer_matrix_values(raw, cooked, num_rows);
+    }
+}
+
+static void update_debounce_counters_and_transfer_if_expired(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, uint8_t elapsed_time) {
+    counters_need_update = false;
+    matrix_need_update   = false;
+
+    for (uint8_t row = 0; row < num_rows; row++) {
+        bitslice_counter_row_t *counters = &bitslice_counters[row];
+        if (!counters->active) {
+            continue;
+        }
+
+        matrix_row_t expired  = bitslice_subtract(counters, elapsed_time);
+        matrix_row_t released = expired & ~debounce_pressed[row];
+
+        // key-down: eager
+        if (expired & debounce_pressed[row]) {
+            matrix_need_update = true;
+        }
+        // key-up: defer
+        cooked[row] = (cooked[row] & ~released) | (raw[row] & released);
+
+        if (counters->active) {
+            counters_need_update = true;
+        }
+    }
+}
+
+static void transfer_matrix_values(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows) {
+    for (uint8_t row = 0; row < num_rows; row++) {
+        bitslice_counter_row_t *counters = &bitslice_counters[row];
+        matrix_row_t            delta    = raw[row] ^ cooked[row];
+        matrix_row_t            idle     = delta & ~counters->active;
+
+        // key-up: defer, restart once the key bounces back
+        bitslice_clear(counters, ~delta & ~debounce_pressed[row]);
+
+        if (idle) {
+            debounce_pressed[row] = (debounce_pressed[row] & ~idle) | (raw[row] & idle);
+            bitslice_load(counters, idle);
+            counters_need_update = true;
+
+            // key-down: eager
+            cooked[row] ^= idle & raw[row];
+        }
+    }
+}
+
+bool debounce_active(void) { return true; }
+#else
+#    include "none.c"
+#endif
@@ -0,0 +1,116 @@
+/*
+Copyright 2021 QMK
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+Vertical (bit-sliced) per-key counters shared by the *_pk_bs debounce algorithms.
+
+Instead of one byte per key, each row keeps DEBOUNCE_BITS matrix_row_t "planes":
+bit n of plane i is bit i of the counter for column n. Loading, clearing and
+decrementing a counter then operate on every column of a row at once, using a
+handful of word-wide boolean operations per plane instead of a loop over columns.
+All storage is static, sized by MATRIX_ROWS, so no heap allocator is required.
+
+DEBOUNCE must be defined (and clamped) before including this file.
+*/
+
+#pragma once
+
+#include "matrix.h"
+
+#if DEBOUNCE < 2
+#    define DEBOUNCE_BITS 1
+#elif DEBOUNCE < 4
+#    define DEBOUNCE_BITS 2
+#elif DEBOUNCE < 8
+#    define DEBOUNCE_BITS 3
+#elif DEBOUNCE < 16
+#    define DEBOUNCE_BITS 4
+#elif DEBOUNCE < 32
+#    define DEBOUNCE_BITS 5
+#elif DEBOUNCE < 64
+#    define DEBOUNCE_BITS 6
+#elif DEBOUNCE < 128
+#    define DEBOUNCE_BITS 7
+#else
+#    define DEBOUNCE_BITS 8
+#endif
+
+typedef struct {
+    matrix_row_t plane[DEBOUNCE_BITS];
+    matrix_row_t active;  // columns with a non-zero counter
+} bitslice_counter_row_t;
+
+static bitslice_counter_row_t bitslice_counters[MATRIX_ROWS];
+
+static inline void bitslice_init(void) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t bit = 0; bit < DEBOUNCE_BITS; bit++) {
+            bitslice_counters[row].plane[bit] = 0;
+        }
+        bitslice_counters[row].active = 0;
+    }
+}
+
+/** \brief Set the counters of the columns in mask to DEBOUNCE */
+static inline void bitslice_load(bitslice_counter_row_t *counters, matrix_row_t mask) {
+    for (uint8_t bit = 0; bit < DEBOUNCE_BITS; bit++) {
+        if (DEBOUNCE & (1 << bit)) {
+            counters->plane[bit] |= mask;
+        } else {
+            counters->plane[bit] &= ~mask;
+        }
+    }
+    counters->active |= mask;
+}
+
+/** \brief Set the counters of the columns in mask to zero (elapsed) */
+static inline void bitslice_clear(bitslice_counter_row_t *counters, matrix_row_t mask) {
+    for (uint8_t bit = 0; bit < DEBOUNCE_BITS; bit++) {
+        counters->plane[bit] &= ~mask;
+    }
+    counters->active &= ~mask;
+}
+
+/** \brief Subtract elapsed_time from every active counter of a row
+ *
+ * Counters that would reach or pass zero are cleared instead.
+ *
+ * \return the columns whose counter expired
+ */
+static inline matrix_row_t bitslice_subtract(bitslice_counter_row_t *counters, uint8_t elapsed_time) {
+    matrix_row_t active = counters->active;
+
+    // Every counter is at most DEBOUNCE, so clamping keeps the comparison exact
+    // while making elapsed_time fit in DEBOUNCE_BITS.
+    if (elapsed_time >= DEBOUNCE) {
+        bitslice_clear(counters, active);
+        return active;
+    }
+
+    matrix_row_t borrow  = 0;
+    matrix_row_t nonzero = 0;
+    for (uint8_t bit = 0; bit < DEBOUNCE_BITS; bit++) {
+        matrix_row_t c = counters->plane[bit];
+        matrix_row_t e = (elapsed_time & (1 << bit)) ? active : 0;
+        matrix_row_t d = c ^ e ^ borrow;
+
+        borrow               = (~c & e) | (~(c ^ e) & borrow);
+        counters->plane[bit] = d;
+        nonzero |= d;
+    }
+
+    matrix_row_t expired = active & (borrow | ~nonzero);
+    bitslice_clear(counters, expired);
+    return expired;
+}
@@ -3,4 +3,7 @@ TEST_LIST += \
 	debounce_sym_defer_pk \
 	debounce_sym_eager_pk \
 	debounce_sym_eager_pr \
-	debounce_asym_eager_defer_pk
+	debounce_asym_eager_defer_pk \
+	debounce_sym_defer_pk_bs \
+	debounce_sym_eager_pk_bs \
+	debounce_asym_eager_defer_pk_bs
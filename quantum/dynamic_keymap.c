@@ -14,6 +14,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
 #include "config.h"
 #include "keymap.h"  // to get keymaps[][][]
 #include "tmk_core/common/eeprom.h"
@@ -83,11 +84,104 @@
 
 uint8_t dynamic_keymap_get_layer_count(void) { return DYNAMIC_KEYMAP_LAYER_COUNT; }
 
+// Number of bytes from offset to transfer so that it stays within a region of region_size bytes
+static uint16_t dynamic_keymap_clamp_size(uint16_t offset, uint16_t size, uint16_t region_size) {
+    if (offset >= region_size) {
+        return 0;
+    }
+    if (size > region_size - offset) {
+        return region_size - offset;
+    }
+    return size;
+}
+
 void *dynamic_keymap_key_to_eeprom_address(uint8_t layer, uint8_t row, uint8_t column) {
     // TODO: optimize this with some left shifts
     return ((void *)DYNAMIC_KEYMAP_EEPROM_ADDR) + (layer * MATRIX_ROWS * MATRIX_COLS * 2) + (row * MATRIX_COLS * 2) + (column * 2);
 }
 
+#ifdef DYNAMIC_KEYMAP_RAM_CACHE
+#    ifndef DYNAMIC_KEYMAP_WRITE_DELAY
+#        define DYNAMIC_KEYMAP_WRITE_DELAY 1000
+#    endif
+
+#    define DYNAMIC_KEYMAP_KEY_COUNT (DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS)
+
+// RAM copy of the keymaps in EEPROM, in host byte order
+static uint16_t dynamic_keymap_cache[DYNAMIC_KEYMAP_KEY_COUNT];
+static bool     dynamic_keymap_cache_loaded = false;
+
+// Keys changed since the last write to EEPROM, from dirty_start up to dirty_end
+static uint16_t dynamic_keymap_dirty_start = DYNAMIC_KEYMAP_KEY_COUNT;
+static uint16_t dynamic_keymap_dirty_end   = 0;
+static uint16_t dynamic_keymap_dirty_timer = 0;
+
+static uint16_t *dynamic_keymap_cache_get(void) {
+    if (!dynamic_keymap_cache_loaded) {
+        eeprom_read_block(dynamic_keymap_cache, (void *)DYNAMIC_KEYMAP_EEPROM_ADDR, sizeof(dynamic_keymap_cache));
+        // Keycodes in EEPROM are big endian
+        for (uint16_t i = 0; i < DYNAMIC_KEYMAP_KEY_COUNT; i++) {
+            uint8_t *bytes          = (uint8_t *)&dynamic_keymap_cache[i];
+            dynamic_keymap_cache[i] = (bytes[0] << 8) | bytes[1];
+        }
+        dynamic_keymap_cache_loaded = true;
+    }
+    return dynamic_keymap_cache;
+}
+
+static void dynamic_keymap_cache_set_dirty(uint16_t start, uint16_t end) {
+    if (start < dynamic_keymap_dirty_start) {
+        dynamic_keymap_dirty_start = start;
+    }
+    if (end > dynamic_keymap_dirty_end) {
+        dynamic_keymap_dirty_end = end;
+    }
+    dynamic_keymap_dirty_timer = timer_read();
+}
+
+void dynamic_keymap_flush(void) {
+    uint8_t  data[32];
+    uint16_t index = dynamic_keymap_dirty_start;
+    while (index < dynamic_keymap_dirty_end) {
+        uint16_t count = dynamic_keymap_dirty_end - index;
+        if (count > sizeof(data) / 2) {
+            count = sizeof(data) / 2;
+        }
+        for (uint16_t i = 0; i < count; i++) {
+            data[i * 2]     = dynamic_keymap_cache[index + i] >> 8;
+            data[i * 2 + 1] = dynamic_keymap_cache[index + i] & 0xFF;
+        }
+        eeprom_update_block(data, ((void *)DYNAMIC_KEYMAP_EEPROM_ADDR) + index * 2, count * 2);
+        index += count;
+    }
+    dynamic_keymap_dirty_start = DYNAMIC_KEYMAP_KEY_COUNT;
+    dynamic_keymap_dirty_end   = 0;
+}
+
+void dynamic_keymap_task(void) {
+    // Wait for changes to settle so a burst of them ends up in a single write
+    if (dynamic_keymap_dirty_end != 0 && timer_elapsed(dynamic_keymap_dirty_timer) > DYNAMIC_KEYMAP_WRITE_DELAY) {
+        dynamic_keymap_flush();
+    }
+}
+
+uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t column) {
+    if (layer >= DYNAMIC_KEYMAP_LAYER_COUNT || row >= MATRIX_ROWS || column >= MATRIX_COLS) {
+        return KC_NO;
+    }
+    return dynamic_keymap_cache_get()[(layer * MATRIX_ROWS + row) * MATRIX_COLS + column];
+}
+
+void dynamic_keymap_set_keycode(uint8_t layer, uint8_t row, uint8_t column, uint16_t keycode) {
+    if (layer >= DYNAMIC_KEYMAP_LAYER_COUNT || row >= MATRIX_ROWS || column >= MATRIX_COLS) {
+        return;
+    }
+    uint16_t index                    = (layer * MATRIX_ROWS + row) * MATRIX_COLS + column;
+    dynamic_keymap_cache_get()[index] = keycode;
+    dynamic_keymap_cache_set_dirty(index, index + 1);
+    layer_cache_invalidate();
+}
+#else
 uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t column) {
     void *address = dynamic_keymap_key_to_eeprom_address(layer, row, column);
     // Big endian, so we can read/write EEPROM directly from host if we want
@@ -99,50 +193,81 @@ uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t column)
 void dynamic_keymap_set_keycode(uint8_t layer, uint8_t row, uint8_t column, uint16_t keycode) {
     void *address = dynamic_keymap_key_to_eeprom_address(layer, row, column);
     // Big endian, so we can read/write EEPROM directly from host if we want
-    eeprom_update_byte(address, (uint8_t)(keycode >> 8));
-    eeprom_update_byte(address + 1, (uint8_t)(keycode & 0xFF));
+    uint8_t data[2] = {keycode >> 8, keycode & 0xFF};
+    eeprom_update_block(data, address, sizeof(data));
+    layer_cache_invalidate();
 }
+#endif
 
 __attribute__((weak))
 void dynamic_keymap_reset(void) {
     // Reset the keymaps in EEPROM to what is in flash.
     // All keyboards using dynamic keymaps should define a layout
     // for the same number of layers as DYNAMIC_KEYMAP_LAYER_COUNT.
+    // Each row is written as one block.
+    uint8_t data[MATRIX_COLS * 2];
     for (int layer = 0; layer < DYNAMIC_KEYMAP_LAYER_COUNT; layer++) {
         for (int row = 0; row < MATRIX_ROWS; row++) {
             for (int column = 0; column < MATRIX_COLS; column++) {
-                dynamic_keymap_set_keycode(layer, row, column, pgm_read_word(&keymaps[layer][row][column]));
+                uint16_t keycode     = pgm_read_word(&keymaps[layer][row][column]);
+                data[column * 2]     = keycode >> 8;
+                data[column * 2 + 1] = keycode & 0xFF;
             }
+            dynamic_keymap_set_buffer((layer * MATRIX_ROWS + row) * MATRIX_COLS * 2, sizeof(data), data);
         }
     }
+#ifdef DYNAMIC_KEYMAP_RAM_CACHE
+    // Callers expect the reset keymap to be in EEPROM when this returns
+    dynamic_keymap_flush();
+#endif
 }
 
 void dynamic_keymap_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
     uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
-    void *   source                     = (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
-    uint8_t *target                     = data;
+#ifdef DYNAMIC_KEYMAP_RAM_CACHE
+    uint16_t *keycodes = dynamic_keymap_cache_get();
     for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < dynamic_keymap_eeprom_size) {
-            *target = eeprom_read_byte(source);
+        uint16_t byte_offset = offset + i;
+        if (byte_offset < dynamic_keymap_eeprom_size) {
+            // Same big endian layout as in EEPROM
+            uint16_t keycode = keycodes[byte_offset / 2];
+            data[i]          = (byte_offset & 1) ? (keycode & 0xFF) : (keycode >> 8);
         } else {
-            *target = 0x00;
+            data[i] = 0x00;
         }
-        source++;
-        target++;
     }
+#else
+    uint16_t count = dynamic_keymap_clamp_size(offset, size, dynamic_keymap_eeprom_size);
+    eeprom_read_block(data, ((void *)DYNAMIC_KEYMAP_EEPROM_ADDR) + offset, count);
+    memset(data + count, 0x00, size - count);
+#endif
 }
 
 void dynamic_keymap_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
     uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
-    void *   target                     = (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
-    uint8_t *source                     = data;
+#ifdef DYNAMIC_KEYMAP_RAM_CACHE
+    uint16_t *keycodes = dynamic_keymap_cache_get();
+    uint16_t  end      = offset;
     for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < dynamic_keymap_eeprom_size) {
-            eeprom_update_byte(target, *source);
+        uint16_t byte_offset = offset + i;
+        if (byte_offset < dynamic_keymap_eeprom_size) {
+            uint16_t *keycode = &keycodes[byte_offset / 2];
+            if (byte_offset & 1) {
+                *keycode = (*keycode & 0xFF00) | data[i];
+            } else {
+                *keycode = (*keycode & 0x00FF) | (data[i] << 8);
+            }
+            end = byte_offset + 1;
         }
-        source++;
-        target++;
     }
+    if (end > offset) {
+        dynamic_keymap_cache_set_dirty(offset / 2, (end + 1) / 2);
+    }
+#else
+    uint16_t count = dynamic_keymap_clamp_size(offset, size, dynamic_keymap_eeprom_size);
+    eeprom_update_block(data, ((void *)DYNAMIC_KEYMAP_EEPROM_ADDR) + offset, count);
+#endif
+    layer_cache_invalidate();
 }
 
 // This overrides the one in quantum/keymap_common.c
@@ -160,94 +285,134 @@ uint8_t dynamic_keymap_macro_get_count(void) { return DYNAMIC_KEYMAP_MACRO_COUNT
 
 uint16_t dynamic_keymap_macro_get_buffer_size(void) { return DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE; }
 
-void dynamic_keymap_macro_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    void *   source = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
-    uint8_t *target = data;
-    for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
-            *target = eeprom_read_byte(source);
-        } else {
-            *target = 0x00;
-        }
-        source++;
-        target++;
+#ifdef DYNAMIC_KEYMAP_RAM_CACHE
+// RAM copy of the macro buffer in EEPROM, written through on every change
+static uint8_t dynamic_keymap_macro_cache[DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE];
+static bool    dynamic_keymap_macro_cache_loaded = false;
+
+static uint8_t *dynamic_keymap_macro_cache_get(void) {
+    if (!dynamic_keymap_macro_cache_loaded) {
+        eeprom_read_block(dynamic_keymap_macro_cache, (void *)DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR, sizeof(dynamic_keymap_macro_cache));
+        dynamic_keymap_macro_cache_loaded = true;
     }
+    return dynamic_keymap_macro_cache;
+}
+
+void dynamic_keymap_init(void) {
+    // Read both copies up front, so the first keypress doesn't wait for the bulk reads
+    dynamic_keymap_cache_get();
+    dynamic_keymap_macro_cache_get();
+}
+#endif
+
+// Offset of every macro in the macro buffer, built on first use after the buffer changed
+static uint16_t dynamic_keymap_macro_offsets[DYNAMIC_KEYMAP_MACRO_COUNT];
+static bool     dynamic_keymap_macro_offsets_valid = false;
+
+static void dynamic_keymap_macro_read(uint16_t offset, uint16_t size, uint8_t *data) {
+#ifdef DYNAMIC_KEYMAP_RAM_CACHE
+    memcpy(data, dynamic_keymap_macro_cache_get() + offset, size);
+#else
+    eeprom_read_block(data, ((void *)DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR) + offset, size);
+#endif
+}
+
+void dynamic_keymap_macro_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
+    uint16_t count = dynamic_keymap_clamp_size(offset, size, DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
+    dynamic_keymap_macro_read(offset, count, data);
+    memset(data + count, 0x00, size - count);
 }
 
 void dynamic_keymap_macro_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    void *   target = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
-    uint8_t *source = data;
-    for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
-            eeprom_update_byte(target, *source);
-        }
-        source++;
-        target++;
-    }
+    uint16_t count = dynamic_keymap_clamp_size(offset, size, DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
+#ifdef DYNAMIC_KEYMAP_RAM_CACHE
+    memcpy(dynamic_keymap_macro_cache_get() + offset, data, count);
+#endif
+    eeprom_update_block(data, ((void *)DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR) + offset, count);
+    dynamic_keymap_macro_offsets_valid = false;
 }
 
 void dynamic_keymap_macro_reset(void) {
-    void *p   = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR);
-    void *end = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
-    while (p != end) {
-        eeprom_update_byte(p, 0);
-        ++p;
+    uint8_t data[32] = {0};
+    for (uint16_t offset = 0; offset < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE; offset += sizeof(data)) {
+        uint16_t count = dynamic_keymap_clamp_size(offset, sizeof(data), DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
+        dynamic_keymap_macro_set_buffer(offset, count, data);
     }
 }
 
-void dynamic_keymap_macro_send(uint8_t id) {
-    if (id >= DYNAMIC_KEYMAP_MACRO_COUNT) {
-        return;
-    }
-
+static bool dynamic_keymap_macro_build_offsets(void) {
     // Check the last byte of the buffer.
     // If it's not zero, then we are in the middle
     // of buffer writing, possibly an aborted buffer
     // write. So do nothing.
-    void *p = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE - 1);
-    if (eeprom_read_byte(p) != 0) {
-        return;
+    uint8_t data[32];
+    dynamic_keymap_macro_read(DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE - 1, 1, data);
+    if (data[0] != 0) {
+        return false;
     }
 
-    // Skip N null characters
-    // p will then point to the Nth macro
-    p         = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR);
-    void *end = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
-    while (id > 0) {
-        // If we are past the end of the buffer, then the buffer
-        // contents are garbage, i.e. there were not DYNAMIC_KEYMAP_MACRO_COUNT
-        // nulls in the buffer.
-        if (p == end) {
-            return;
-        }
-        if (eeprom_read_byte(p) == 0) {
-            --id;
+    // Each macro starts after the null terminator of the previous one.
+    // Macros past the end of the buffer are marked with an offset
+    // of DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE, as the buffer contents are
+    // garbage, i.e. there were not DYNAMIC_KEYMAP_MACRO_COUNT nulls in it.
+    uint8_t id                      = 0;
+    dynamic_keymap_macro_offsets[0] = 0;
+    for (uint16_t offset = 0; offset < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE && id < DYNAMIC_KEYMAP_MACRO_COUNT - 1; offset += sizeof(data)) {
+        uint16_t count = dynamic_keymap_clamp_size(offset, sizeof(data), DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
+        dynamic_keymap_macro_read(offset, count, data);
+        for (uint16_t i = 0; i < count && id < DYNAMIC_KEYMAP_MACRO_COUNT - 1; i++) {
+            if (data[i] == 0) {
+                dynamic_keymap_macro_offsets[++id] = offset + i + 1;
+            }
         }
-        ++p;
+    }
+    while (++id < DYNAMIC_KEYMAP_MACRO_COUNT) {
+        dynamic_keymap_macro_offsets[id] = DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE;
+    }
+
+    dynamic_keymap_macro_offsets_valid = true;
+    return true;
+}
+
+void dynamic_keymap_macro_send(uint8_t id) {
+    if (id >= DYNAMIC_KEYMAP_MACRO_COUNT) {
+        return;
     }
 
-    // Send the macro string one or three chars at a time
-    // by making temporary 1 or 3 char strings
-    char data[4] = {0, 0, 0, 0};
+    if (!dynamic_keymap_macro_offsets_valid && !dynamic_keymap_macro_build_offsets()) {
+        return;
+    }
+
+    // Send the macro string a block at a time.
+    // Magic chars (tap, down, up) apply to the key in the next char,
+    // which may be in the next block.
+    uint8_t  data[16];
+    uint8_t  magic  = 0;
+    uint16_t offset = dynamic_keymap_macro_offsets[id];
     // We already checked there was a null at the end of
     // the buffer, so this cannot go past the end
-    while (1) {
-        data[0] = eeprom_read_byte(p++);
-        data[1] = 0;
-        // Stop at the null terminator of this macro string
-        if (data[0] == 0) {
-            break;
-        }
-        // If the char is magic (tap, down, up),
-        // add the next char (key to use) and send a 3 char string.
-        if (data[0] == SS_TAP_CODE || data[0] == SS_DOWN_CODE || data[0] == SS_UP_CODE) {
-            data[1] = data[0];
-            data[0] = SS_QMK_PREFIX;
-            data[2] = eeprom_read_byte(p++);
-            if (data[2] == 0) {
-                break;
+    while (offset < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
+        uint16_t count = dynamic_keymap_clamp_size(offset, sizeof(data), DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
+        dynamic_keymap_macro_read(offset, count, data);
+        for (uint16_t i = 0; i < count; i++) {
+            // Stop at the null terminator of this macro string
+            if (data[i] == 0) {
+                return;
+            }
+            if (magic == SS_TAP_CODE) {
+                tap_code(data[i]);
+            } else if (magic == SS_DOWN_CODE) {
+                register_code(data[i]);
+            } else if (magic == SS_UP_CODE) {
+                unregister_code(data[i]);
+            } else if (data[i] == SS_TAP_CODE || data[i] == SS_DOWN_CODE || data[i] == SS_UP_CODE) {
+                magic = data[i];
+                continue;
+            } else {
+                send_char(data[i]);
             }
+            magic = 0;
         }
-        send_string(data);
+        offset += count;
     }
 }
@@ -34,6 +34,19 @@ void     dynamic_keymap_reset(void);
 void dynamic_keymap_get_buffer(uint16_t offset, uint16_t size, uint8_t *data);
 void dynamic_keymap_set_buffer(uint16_t offset, uint16_t size, uint8_t *data);
 
+#ifdef DYNAMIC_KEYMAP_RAM_CACHE
+// With DYNAMIC_KEYMAP_RAM_CACHE, keycodes are read from and written to a copy
+// of the keymaps in RAM. Changes are written to EEPROM by dynamic_keymap_task()
+// once no further change was made for DYNAMIC_KEYMAP_WRITE_DELAY ms, or right
+// away by dynamic_keymap_flush(), which reset_keyboard() also calls before
+// jumping to the bootloader. The macro buffer is also kept in RAM, but
+// is written to EEPROM right away. Both are read by dynamic_keymap_init(),
+// which keyboard_init() calls once VIA has checked the EEPROM.
+void dynamic_keymap_init(void);
+void dynamic_keymap_flush(void);
+void dynamic_keymap_task(void);
+#endif
+
 // This overrides the one in quantum/keymap_common.c
 // uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key);
 
@@ -31,6 +31,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "sendchar.h"
 #include "eeconfig.h"
 #include "action_layer.h"
+#include "task_timing.h"
 #ifdef BACKLIGHT_ENABLE
 #    include "backlight.h"
 #endif
@@ -94,6 +95,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef VIA_ENABLE
 #    include "via.h"
 #endif
+#ifdef DYNAMIC_KEYMAP_ENABLE
+#    include "dynamic_keymap.h"
+#endif
 #ifdef DIP_SWITCH_ENABLE
 #    include "dip_switch.h"
 #endif
@@ -302,6 +306,9 @@ void housekeeping_task(void) {
     housekeeping_task_user();
 }
 
+// time of the last event passed to action_exec(), see action_exec_in_order()
+static uint16_t last_event_time = 0;
+
 /** \brief keyboard_init
  *
  * FIXME: needs doc
@@ -309,8 +316,12 @@ void housekeeping_task(void) {
 void keyboard_init(void) {
     timer_init();
     sync_timer_init();
+    last_event_time = 0;
 #ifdef VIA_ENABLE
     via_init();
+#endif
+#if defined(DYNAMIC_KEYMAP_ENABLE) && defined(DYNAMIC_KEYMAP_RAM_CACHE)
+    dynamic_keymap_init();
 #endif
     matrix_init();
 #if defined(CRC_ENABLE)
@@ -378,6 +389,118 @@ void switch_events(uint8_t row, uint8_t col, bool pressed) {
 #endif
 }
 
+#ifdef QMK_EVENT_QUEUE
+#    ifndef QMK_EVENT_QUEUE_SIZE
+#        define QMK_EVENT_QUEUE_SIZE 16
+#    endif
+_Static_assert(QMK_EVENT_QUEUE_SIZE <= 256, "QMK_EVENT_QUEUE_SIZE must not exceed 256");
+// Most events processed by one keyboard_task() call, so a burst can't hold up the other tasks for long
+#    ifndef QMK_EVENT_QUEUE_DRAIN_LIMIT
+#        ifdef QMK_KEYS_PER_SCAN
+#            define QMK_EVENT_QUEUE_DRAIN_LIMIT QMK_KEYS_PER_SCAN
+#        else
+#            define QMK_EVENT_QUEUE_DRAIN_LIMIT 8
+#        endif
+#    endif
+
+// Matrix changes waiting to be passed to action_exec(), oldest at the tail
+static keyevent_t event_queue[QMK_EVENT_QUEUE_SIZE];
+static uint8_t    event_queue_head = 0;
+static uint8_t    event_queue_tail = 0;
+
+static inline bool event_queue_is_empty(void) { return event_queue_head == event_queue_tail; }
+
+static inline bool event_queue_is_full(void) { return ((event_queue_head + 1) % QMK_EVENT_QUEUE_SIZE) == event_queue_tail; }
+
+static inline void event_queue_push(keyevent_t event) {
+    event_queue[event_queue_head] = event;
+    event_queue_head              = (event_queue_head + 1) % QMK_EVENT_QUEUE_SIZE;
+}
+
+static inline keyevent_t event_queue_pop(void) {
+    keyevent_t event = event_queue[event_queue_tail];
+    event_queue_tail = (event_queue_tail + 1) % QMK_EVENT_QUEUE_SIZE;
+    return event;
+}
+#endif
+
+/** \brief Pass an event to action_exec() without letting event times go backwards
+ *
+ * Changes are processed in matrix order, so a change waiting from an earlier
+ * scan can be processed after a newer one in a lower row. Tapping and combos
+ * compare event times with TIMER_DIFF_16(), which would wrap on a time older
+ * than the previous event's, so such an event gets the previous event's time.
+ *
+ * Both times are compared by their age, so a last_event_time from before a
+ * long idle (e.g. USB suspend) never counts as newer than a fresh event.
+ */
+static void action_exec_in_order(keyevent_t event) {
+    uint16_t now = timer_read() | 1; /* event times are stamped the same way */
+    // event.time is older than last_event_time
+    if (last_event_time && TIMER_DIFF_16(now, event.time) > TIMER_DIFF_16(now, last_event_time)) {
+        event.time = last_event_time;
+    }
+    last_event_time = event.time;
+    action_exec(event);
+}
+
+#ifndef QMK_EVENT_QUEUE
+#    ifndef QMK_WAITING_KEY_STAMPS
+#        define QMK_WAITING_KEY_STAMPS 8
+#    endif
+
+typedef struct {
+    keypos_t key;
+    uint16_t time;
+} waiting_stamp_t;
+
+static waiting_stamp_t waiting_stamps[QMK_WAITING_KEY_STAMPS];
+static uint8_t         waiting_stamp_count = 0;
+
+/** \brief Remember the scan that first saw a change left waiting in the matrix
+ *
+ * Only one change is processed per keyboard_task() call (or QMK_KEYS_PER_SCAN),
+ * so the rest wait in the matrix. Each waiting key keeps the time of the scan
+ * that first saw its change, which keeps tapping and combo decisions independent
+ * of how long the change waits. If the list is full the change is stamped when
+ * it is processed instead.
+ */
+static void waiting_stamp_add(uint8_t row, uint8_t col, uint16_t scan_time) {
+    for (uint8_t i = 0; i < waiting_stamp_count; i++) {
+        if (waiting_stamps[i].key.row == row && waiting_stamps[i].key.col == col) return;
+    }
+    if (waiting_stamp_count < QMK_WAITING_KEY_STAMPS) {
+        waiting_stamps[waiting_stamp_count++] = (waiting_stamp_t){.key = (keypos_t){.row = row, .col = col}, .time = scan_time};
+    }
+}
+
+/** \brief Time of the scan that first saw a key's change, and forget it
+ */
+static uint16_t waiting_stamp_take(uint8_t row, uint8_t col, uint16_t scan_time) {
+    for (uint8_t i = 0; i < waiting_stamp_count; i++) {
+        if (waiting_stamps[i].key.row == row && waiting_stamps[i].key.col == col) {
+            scan_time         = waiting_stamps[i].time;
+            waiting_stamps[i] = waiting_stamps[--waiting_stamp_count];
+            break;
+        }
+    }
+    return scan_time;
+}
+
+/** \brief Forget keys whose change went away before it was processed
+ */
+static void waiting_stamp_prune(const matrix_row_t matrix_prev[]) {
+    for (uint8_t i = 0; i < waiting_stamp_count;) {
+        keypos_t key = waiting_stamps[i].key;
+        if ((matrix_get_row(key.row) ^ matrix_prev[key.row]) & ((matrix_row_t)1 << key.col)) {
+            i++;
+        } else {
+            waiting_stamps[i] = waiting_stamps[--waiting_stamp_count];
+        }
+    }
+}
+#endif
+
 /** \brief Keyboard task: Do keyboard routine jobs
  *
  * Do routine keyboard jobs:
@@ -395,16 +518,31 @@ void keyboard_task(void) {
     static uint8_t      led_status    = 0;
     matrix_row_t        matrix_row    = 0;
     matrix_row_t        matrix_change = 0;
-#ifdef QMK_KEYS_PER_SCAN
+#if defined(QMK_KEYS_PER_SCAN) || defined(QMK_EVENT_QUEUE)
     uint8_t keys_processed = 0;
 #endif
 #ifdef ENCODER_ENABLE
     bool encoders_changed = false;
 #endif
+    uint8_t matrix_changed;
+    TASK_TIMING_START(scan_start);
+
+    // every change is stamped with the time the matrix was read, not the time it is processed
+    const uint16_t scan_time = timer_read() | 1; /* time should not be 0 */
 
-    uint8_t matrix_changed = matrix_scan();
+    TASK_TIMING(TASK_TIMING_MATRIX_SCAN, matrix_changed = matrix_scan());
     if (matrix_changed) last_matrix_activity_trigger();
 
+    TASK_TIMING_START(action_start);
+
+#ifndef QMK_EVENT_QUEUE
+    // set once this call has processed its share, the remaining changes are only stamped
+    bool waiting = false;
+    if (waiting_stamp_count && matrix_changed) {
+        waiting_stamp_prune(matrix_prev);
+    }
+#endif
+
     for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
         matrix_row    = matrix_get_row(r);
         matrix_change = matrix_row ^ matrix_prev[r];
@@ -418,67 +556,99 @@ void keyboard_task(void) {
             matrix_row_t col_mask = 1;
             for (uint8_t c = 0; c < MATRIX_COLS; c++, col_mask <<= 1) {
                 if (matrix_change & col_mask) {
+#ifdef QMK_EVENT_QUEUE
+                    // leave the rest of the changes in the matrix for the next scan
+                    if (event_queue_is_full()) goto MATRIX_QUEUE_FULL;
+                    if (should_process_keypress()) {
+                        event_queue_push((keyevent_t){.key = (keypos_t){.row = r, .col = c}, .pressed = (matrix_row & col_mask), .time = scan_time});
+                    }
+                    // record a queued key
+                    matrix_prev[r] ^= col_mask;
+
+                    switch_events(r, c, (matrix_row & col_mask));
+#else
+                    if (waiting) {
+                        waiting_stamp_add(r, c, scan_time);
+                        continue;
+                    }
                     if (should_process_keypress()) {
-                        action_exec((keyevent_t){
-                            .key = (keypos_t){.row = r, .col = c}, .pressed = (matrix_row & col_mask), .time = (timer_read() | 1) /* time should not be 0 */
-                        });
+                        action_exec_in_order((keyevent_t){.key = (keypos_t){.row = r, .col = c}, .pressed = (matrix_row & col_mask), .time = waiting_stamp_take(r, c, scan_time)});
                     }
                     // record a processed key
                     matrix_prev[r] ^= col_mask;
 
                     switch_events(r, c, (matrix_row & col_mask));
 
-#ifdef QMK_KEYS_PER_SCAN
+#    ifdef QMK_KEYS_PER_SCAN
                     // only jump out if we have processed "enough" keys.
                     if (++keys_processed >= QMK_KEYS_PER_SCAN)
+#    endif
+                    {
+                        // process a key per task call, changes only this scan saw still need a stamp
+                        if (!matrix_changed) goto MATRIX_LOOP_END;
+                        waiting = true;
+                    }
 #endif
-                        // process a key per task call
-                        goto MATRIX_LOOP_END;
                 }
             }
         }
     }
+
+#ifdef QMK_EVENT_QUEUE
+MATRIX_QUEUE_FULL:
+    // drain the queue in scan order, the rest is left for the next call
+    while (!event_queue_is_empty() && keys_processed < QMK_EVENT_QUEUE_DRAIN_LIMIT) {
+        action_exec_in_order(event_queue_pop());
+        keys_processed++;
+    }
+#else
+    if (waiting) goto MATRIX_LOOP_END;
+#endif
+
     // call with pseudo tick event when no real key event.
-#ifdef QMK_KEYS_PER_SCAN
+#if defined(QMK_KEYS_PER_SCAN) || defined(QMK_EVENT_QUEUE)
     // we can get here with some keys processed now.
     if (!keys_processed)
 #endif
-        action_exec(TICK);
+        action_exec_in_order(TICK);
 
+#ifndef QMK_EVENT_QUEUE
 MATRIX_LOOP_END:
+#endif
+    TASK_TIMING_STOP(TASK_TIMING_ACTION, action_start);
 
 #ifdef DEBUG_MATRIX_SCAN_RATE
     matrix_scan_perf_task();
 #endif
 
 #if defined(RGBLIGHT_ENABLE)
-    rgblight_task();
+    TASK_TIMING(TASK_TIMING_RGBLIGHT, rgblight_task());
 #endif
 
 #ifdef LED_MATRIX_ENABLE
-    led_matrix_task();
+    TASK_TIMING(TASK_TIMING_LED_MATRIX, led_matrix_task());
 #endif
 #ifdef RGB_MATRIX_ENABLE
-    rgb_matrix_task();
+    TASK_TIMING(TASK_TIMING_RGB_MATRIX, rgb_matrix_task());
 #endif
 
 #if defined(BACKLIGHT_ENABLE)
 #    if defined(BACKLIGHT_PIN) || defined(BACKLIGHT_PINS)
-    backlight_task();
+    TASK_TIMING(TASK_TIMING_BACKLIGHT, backlight_task());
 #    endif
 #endif
 
 #ifdef ENCODER_ENABLE
-    encoders_changed = encoder_read();
+    TASK_TIMING(TASK_TIMING_ENCODER, encoders_changed = encoder_read());
     if (encoders_changed) last_encoder_activity_trigger();
 #endif
 
 #ifdef QWIIC_ENABLE
-    qwiic_task();
+    TASK_TIMING(TASK_TIMING_QWIIC, qwiic_task());
 #endif
 
 #ifdef OLED_ENABLE
-    oled_task();
+    TASK_TIMING(TASK_TIMING_OLED, oled_task());
 #    if OLED_TIMEOUT > 0
     // Wake up oled if user is using those fabulous keys or spinning those encoders!
 #        ifdef ENCODER_ENABLE
@@ -490,7 +660,7 @@ MATRIX_LOOP_END:
 #endif
 
 #ifdef ST7565_ENABLE
-    st7565_task();
+    TASK_TIMING(TASK_TIMING_ST7565, st7565_task());
 #    if ST7565_TIMEOUT > 0
     // Wake up display if user is using those fabulous keys or spinning those encoders!
 #        ifdef ENCODER_ENABLE
@@ -503,9 +673,11 @@ MATRIX_LOOP_END:
 
 #ifdef MOUSEKEY_ENABLE
     // mousekey repeat & acceleration
-    mousekey_task();
+    TASK_TIMING(TASK_TIMING_MOUSEKEY, mousekey_task());
 #endif
 
+    TASK_TIMING_START(other_start);
+
 #ifdef PS2_MOUSE_ENABLE
     ps2_mouse_task();
 #endif
@@ -526,12 +698,14 @@ MATRIX_LOOP_END:
     visualizer_update(default_layer_state, layer_state, visualizer_get_mods(), host_keyboard_leds());
 #endif
 
+    TASK_TIMING_STOP(TASK_TIMING_OTHER, other_start);
+
 #ifdef POINTING_DEVICE_ENABLE
-    pointing_device_task();
+    TASK_TIMING(TASK_TIMING_POINTING_DEVICE, pointing_device_task());
 #endif
 
 #ifdef MIDI_ENABLE
-    midi_task();
+    TASK_TIMING(TASK_TIMING_MIDI, midi_task());
 #endif
 
 #ifdef VELOCIKEY_ENABLE
@@ -541,11 +715,15 @@ MATRIX_LOOP_END:
 #endif
 
 #ifdef JOYSTICK_ENABLE
-    joystick_task();
+    TASK_TIMING(TASK_TIMING_JOYSTICK, joystick_task());
 #endif
 
 #ifdef DIGITIZER_ENABLE
-    digitizer_task();
+    TASK_TIMING(TASK_TIMING_DIGITIZER, digitizer_task());
+#endif
+
+#if defined(DYNAMIC_KEYMAP_ENABLE) && defined(DYNAMIC_KEYMAP_RAM_CACHE)
+    dynamic_keymap_task();
 #endif
 
     // update LED
@@ -553,6 +731,11 @@ MATRIX_LOOP_END:
         led_status = host_keyboard_leds();
         keyboard_set_leds(led_status);
     }
+
+    TASK_TIMING_STOP(TASK_TIMING_SCAN, scan_start);
+#ifdef TASK_TIMING_ENABLE
+    task_timing_task();
+#endif
 }
 
 /** \brief keyboard set leds
@@ -43,6 +43,241 @@ action_t action_for_key(uint8_t layer, keypos_t key) {
     return action_for_keycode(keycode);
 };
 
+#ifdef ACTION_KEYCODE_TABLE
+/* Kind of action a keycode resolves to. The keycode ranges are laid out at
+ * build time in two tables, one for the high byte of the keycode and one for
+ * basic keycodes, so that resolving an action is a couple of table reads.
+ */
+enum keycode_action_kind {
+    KA_NO = 0,
+    KA_KEY,
+    KA_SYSTEM,
+    KA_CONSUMER,
+    KA_MOUSEKEY,
+    KA_TRANSPARENT,
+    KA_FN,
+    KA_MODS_KEY,
+    KA_FUNCTION,
+    KA_MACRO,
+    KA_LAYER_TAP,
+    KA_TO,
+    KA_MOMENTARY,
+    KA_DEF_LAYER,
+    KA_TOGGLE_LAYER,
+    KA_ONE_SHOT_LAYER,
+    KA_ONE_SHOT_MOD,
+    KA_LAYER_TAP_TOGGLE,
+    KA_LAYER_MOD,
+    KA_MOD_TAP,
+    KA_SWAP_HANDS,
+    KA_MAGIC, /* basic keycodes remapped by keycode_config(), followed by their slot */
+};
+
+/* Basic keycodes that keycode_config() may remap */
+static const uint8_t PROGMEM magic_keycodes[] = {KC_CAPSLOCK, KC_LOCKING_CAPS, KC_LCTL, KC_LALT, KC_LGUI, KC_RCTL, KC_RALT, KC_RGUI, KC_GRAVE, KC_ESC, KC_BSLASH, KC_BSPACE};
+#    define MAGIC_KEYCODE_COUNT (sizeof(magic_keycodes) / sizeof(magic_keycodes[0]))
+
+static const uint8_t PROGMEM basic_action_kinds[256] = {
+    [KC_A ... KC_EXSEL]    = KA_KEY,
+    [KC_LCTRL ... KC_RGUI] = KA_KEY,
+#    ifdef EXTRAKEY_ENABLE
+    [KC_SYSTEM_POWER ... KC_SYSTEM_WAKE]    = KA_SYSTEM,
+    [KC_AUDIO_MUTE ... KC_BRIGHTNESS_DOWN] = KA_CONSUMER,
+#    endif
+#    ifdef MOUSEKEY_ENABLE
+    [KC_MS_UP ... KC_MS_ACCEL2] = KA_MOUSEKEY,
+#    endif
+    [KC_TRNS] = KA_TRANSPARENT,
+#    ifndef NO_ACTION_FUNCTION
+    [KC_FN0 ... KC_FN31] = KA_FN,
+#    endif
+    // must match the order of magic_keycodes
+    [KC_CAPSLOCK]     = KA_MAGIC + 0,
+    [KC_LOCKING_CAPS] = KA_MAGIC + 1,
+    [KC_LCTL]         = KA_MAGIC + 2,
+    [KC_LALT]         = KA_MAGIC + 3,
+    [KC_LGUI]         = KA_MAGIC + 4,
+    [KC_RCTL]         = KA_MAGIC + 5,
+    [KC_RALT]         = KA_MAGIC + 6,
+    [KC_RGUI]         = KA_MAGIC + 7,
+    [KC_GRAVE]        = KA_MAGIC + 8,
+    [KC_ESC]          = KA_MAGIC + 9,
+    [KC_BSLASH]       = KA_MAGIC + 10,
+    [KC_BSPACE]       = KA_MAGIC + 11,
+};
+
+/* Indexed by the high byte of the keycode, everything from QK_UNICODE up is KA_NO */
+static const uint8_t PROGMEM quantum_action_kinds[QK_UNICODE >> 8] = {
+    [QK_MODS >> 8 ... QK_MODS_MAX >> 8] = KA_MODS_KEY,
+#    ifndef NO_ACTION_FUNCTION
+    [QK_FUNCTION >> 8 ... QK_FUNCTION_MAX >> 8] = KA_FUNCTION,
+#    endif
+#    ifndef NO_ACTION_MACRO
+    [QK_MACRO >> 8 ... QK_MACRO_MAX >> 8] = KA_MACRO,
+#    endif
+#    ifndef NO_ACTION_LAYER
+    [QK_LAYER_TAP >> 8 ... QK_LAYER_TAP_MAX >> 8] = KA_LAYER_TAP,
+    [QK_TO >> 8]                                  = KA_TO,
+    [QK_MOMENTARY >> 8]                           = KA_MOMENTARY,
+    [QK_DEF_LAYER >> 8]                           = KA_DEF_LAYER,
+    [QK_TOGGLE_LAYER >> 8]                        = KA_TOGGLE_LAYER,
+    [QK_LAYER_TAP_TOGGLE >> 8]                    = KA_LAYER_TAP_TOGGLE,
+    [QK_LAYER_MOD >> 8]                           = KA_LAYER_MOD,
+#    endif
+#    ifndef NO_ACTION_ONESHOT
+    [QK_ONE_SHOT_LAYER >> 8] = KA_ONE_SHOT_LAYER,
+    [QK_ONE_SHOT_MOD >> 8]   = KA_ONE_SHOT_MOD,
+#    endif
+#    ifndef NO_ACTION_TAPPING
+    [QK_MOD_TAP >> 8 ... QK_MOD_TAP_MAX >> 8] = KA_MOD_TAP,
+#    endif
+#    ifdef SWAP_HANDS_ENABLE
+    [QK_SWAP_HANDS >> 8] = KA_SWAP_HANDS,
+#    endif
+};
+
+/* keycode_config() and mod_config() folded in for the current keymap_config */
+static uint16_t magic_actions[MAGIC_KEYCODE_COUNT];
+static uint8_t  mod_config_table[32];
+static uint16_t keycode_table_config = 0;
+static bool     keycode_table_valid  = false;
+
+static uint16_t basic_keycode_to_action(uint8_t keycode, uint8_t kind);
+
+/** \brief Rebuilds the keycode remapping tables after keymap_config changes */
+static void keycode_table_update(void) {
+    for (uint8_t i = 0; i < MAGIC_KEYCODE_COUNT; i++) {
+        uint8_t keycode  = keycode_config(pgm_read_byte(&magic_keycodes[i]));
+        magic_actions[i] = basic_keycode_to_action(keycode, pgm_read_byte(&basic_action_kinds[keycode]));
+    }
+    // mod_config() only changes the five modifier bits
+    for (uint8_t mod = 0; mod < 32; mod++) {
+        mod_config_table[mod] = mod_config(mod);
+    }
+    keycode_table_config = keymap_config.raw;
+    keycode_table_valid  = true;
+}
+
+static inline uint8_t mod_config_lookup(uint8_t mod) { return mod_config_table[mod & 0x1F] | (mod & 0xE0); }
+
+static uint16_t basic_keycode_to_action(uint8_t keycode, uint8_t kind) {
+    switch (kind) {
+        case KA_KEY:
+            return ACTION_KEY(keycode);
+#    ifdef EXTRAKEY_ENABLE
+        case KA_SYSTEM:
+            return ACTION_USAGE_SYSTEM(KEYCODE2SYSTEM(keycode));
+        case KA_CONSUMER:
+            return ACTION_USAGE_CONSUMER(KEYCODE2CONSUMER(keycode));
+#    endif
+#    ifdef MOUSEKEY_ENABLE
+        case KA_MOUSEKEY:
+            return ACTION_MOUSEKEY(keycode);
+#    endif
+        case KA_TRANSPARENT:
+            return ACTION_TRANSPARENT;
+#    ifndef NO_ACTION_FUNCTION
+        case KA_FN:
+            return keymap_function_id_to_action(FN_INDEX(keycode));
+#    endif
+        case KA_NO:
+            return ACTION_NO;
+        default:
+            // the targets of keycode_config() are never remapped again
+            if (keycode == KC_NO) {
+                return ACTION_NO;
+            }
+            return ACTION_KEY(keycode);
+    }
+}
+
+action_t action_for_keycode(uint16_t keycode) {
+    action_t action;
+
+    if (!keycode_table_valid || keycode_table_config != keymap_config.raw) {
+        keycode_table_update();
+    }
+
+    if (keycode <= QK_BASIC_MAX) {
+        uint8_t kind = pgm_read_byte(&basic_action_kinds[keycode]);
+        if (kind >= KA_MAGIC) {
+            action.code = magic_actions[kind - KA_MAGIC];
+        } else {
+            action.code = basic_keycode_to_action(keycode, kind);
+        }
+        return action;
+    }
+
+    if (keycode >= QK_UNICODE) {
+        action.code = ACTION_NO;
+        return action;
+    }
+
+    switch (pgm_read_byte(&quantum_action_kinds[keycode >> 8])) {
+        case KA_MODS_KEY:
+            action.code = ACTION_MODS_KEY(keycode >> 8, keycode & 0xFF);
+            break;
+#    ifndef NO_ACTION_FUNCTION
+        case KA_FUNCTION:
+            action.code = keymap_function_id_to_action((int)keycode & 0xFFF);
+            break;
+#    endif
+#    ifndef NO_ACTION_MACRO
+        case KA_MACRO:
+            if (keycode & 0x800)  // tap macros have upper bit set
+                action.code = ACTION_MACRO_TAP(keycode & 0xFF);
+            else
+                action.code = ACTION_MACRO(keycode & 0xFF);
+            break;
+#    endif
+#    ifndef NO_ACTION_LAYER
+        case KA_LAYER_TAP:
+            action.code = ACTION_LAYER_TAP_KEY((keycode >> 0x8) & 0xF, keycode & 0xFF);
+            break;
+        case KA_TO:
+            action.code = ACTION_LAYER_SET(keycode & 0xF, (keycode >> 0x4) & 0x3);
+            break;
+        case KA_MOMENTARY:
+            action.code = ACTION_LAYER_MOMENTARY(keycode & 0xFF);
+            break;
+        case KA_DEF_LAYER:
+            action.code = ACTION_DEFAULT_LAYER_SET(keycode & 0xFF);
+            break;
+        case KA_TOGGLE_LAYER:
+            action.code = ACTION_LAYER_TOGGLE(keycode & 0xFF);
+            break;
+        case KA_LAYER_TAP_TOGGLE:
+            action.code = ACTION_LAYER_TAP_TOGGLE(keycode & 0xFF);
+            break;
+        case KA_LAYER_MOD:
+            action.code = ACTION_LAYER_MODS((keycode >> 4) & 0xF, mod_config_lookup(keycode & 0xF));
+            break;
+#    endif
+#    ifndef NO_ACTION_ONESHOT
+        case KA_ONE_SHOT_LAYER:
+            action.code = ACTION_LAYER_ONESHOT(keycode & 0xFF);
+            break;
+        case KA_ONE_SHOT_MOD:
+            action.code = ACTION_MODS_ONESHOT(mod_config_lookup(keycode & 0xFF));
+            break;
+#    endif
+#    ifndef NO_ACTION_TAPPING
+        case KA_MOD_TAP:
+            action.code = ACTION_MODS_TAP_KEY(mod_config_lookup((keycode >> 0x8) & 0x1F), keycode & 0xFF);
+            break;
+#    endif
+#    ifdef SWAP_HANDS_ENABLE
+        case KA_SWAP_HANDS:
+            action.code = ACTION(ACT_SWAP_HANDS, keycode & 0xff);
+            break;
+#    endif
+        default:
+            action.code = ACTION_NO;
+            break;
+    }
+    return action;
+}
+#else
 action_t action_for_keycode(uint16_t keycode) {
     // keycode remapping
     keycode = keycode_config(keycode);
@@ -164,6 +399,7 @@ action_t action_for_keycode(uint16_t keycode) {
     }
     return action;
 }
+#endif
 
 __attribute__((weak)) const uint16_t PROGMEM fn_actions[] = {
 
@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "matrix.h"
 #include "debounce.h"
 #include "quantum.h"
+#include "task_timing.h"
 #ifdef SPLIT_KEYBOARD
 #    include "split_common/split_util.h"
 #    include "split_common/transactions.h"
@@ -252,6 +253,184 @@ __attribute__((weak)) void matrix_read_rows_on_col(matrix_row_t current_matrix[]
 #    error DIODE_DIRECTION is not defined!
 #endif
 
+#ifdef MATRIX_IDLE_SCAN_TIMEOUT
+#    if !defined(DIRECT_PINS) && !(defined(MATRIX_ROW_PINS) && defined(MATRIX_COL_PINS))
+#        error MATRIX_IDLE_SCAN_TIMEOUT requires DIRECT_PINS or MATRIX_ROW_PINS and MATRIX_COL_PINS
+#    endif
+
+/* Idle scanning
+ *
+ * Once no key has been down for MATRIX_IDLE_SCAN_TIMEOUT milliseconds, every
+ * output line is driven active at the same time, so that a key press anywhere
+ * shows up on its input line. matrix_scan() then stops strobing the matrix and
+ * only checks for that, either through an edge interrupt armed by
+ * matrix_idle_arm() or by reading the inputs once per call, and does a full
+ * scan again in the same call as soon as an input goes active.
+ *
+ * With edge interrupts, matrix_scan() also blocks in matrix_idle_wait() for up
+ * to MATRIX_IDLE_WAIT milliseconds per call, so the MCU can sleep between
+ * passes of the main loop. When polling, only the strobing is saved and the
+ * main loop keeps running at full rate.
+ */
+#    ifndef MATRIX_IDLE_WAIT
+#        define MATRIX_IDLE_WAIT 1
+#    endif
+
+static bool          matrix_idle       = false;
+static bool          matrix_idle_armed = false;
+static volatile bool matrix_idle_woken = false;
+static uint32_t      matrix_idle_timer = 0;
+
+#    if defined(DIRECT_PINS)
+#        define MATRIX_IDLE_INPUTS (ROWS_PER_HAND * MATRIX_COLS)
+static inline pin_t matrix_idle_input(uint8_t index) { return direct_pins[index / MATRIX_COLS][index % MATRIX_COLS]; }
+#    elif (DIODE_DIRECTION == COL2ROW)
+#        define MATRIX_IDLE_INPUTS (MATRIX_COLS)
+static inline pin_t matrix_idle_input(uint8_t index) { return col_pins[index]; }
+#    elif (DIODE_DIRECTION == ROW2COL)
+#        define MATRIX_IDLE_INPUTS (ROWS_PER_HAND)
+static inline pin_t matrix_idle_input(uint8_t index) { return row_pins[index]; }
+#    endif
+
+/** \brief Drive every matrix output active (idle) or release them again */
+__attribute__((weak)) void matrix_idle_pins(bool idle) {
+#    if !defined(DIRECT_PINS) && (DIODE_DIRECTION == COL2ROW)
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        if (idle) {
+            select_row(row);
+        } else {
+            unselect_row(row);
+        }
+    }
+#    elif !defined(DIRECT_PINS) && (DIODE_DIRECTION == ROW2COL)
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        if (idle) {
+            select_col(col);
+        } else {
+            unselect_col(col);
+        }
+    }
+#    endif
+}
+
+/** \brief Whether any input is active while the outputs are driven by matrix_idle_pins() */
+__attribute__((weak)) bool matrix_idle_read_pins(void) {
+    for (uint8_t i = 0; i < MATRIX_IDLE_INPUTS; i++) {
+        if (readMatrixPin(matrix_idle_input(i)) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** \brief Leave idle scanning at the next matrix_scan(). Safe to call from an interrupt. */
+void matrix_idle_wakeup(void) { matrix_idle_woken = true; }
+
+#    if defined(PROTOCOL_CHIBIOS) && (PAL_USE_CALLBACKS == TRUE)
+static BSEMAPHORE_DECL(matrix_idle_sem, true);
+
+static void matrix_idle_pal_callback(void *arg) {
+    matrix_idle_wakeup();
+    chSysLockFromISR();
+    chBSemSignalI(&matrix_idle_sem);
+    chSysUnlockFromISR();
+}
+
+__attribute__((weak)) bool matrix_idle_arm(void) {
+    chBSemReset(&matrix_idle_sem, true);
+    for (uint8_t i = 0; i < MATRIX_IDLE_INPUTS; i++) {
+        pin_t pin = matrix_idle_input(i);
+        if (pin != NO_PIN) {
+            palEnableLineEvent(pin, PAL_EVENT_MODE_FALLING_EDGE);
+            palSetLineCallback(pin, matrix_idle_pal_callback, NULL);
+        }
+    }
+    return true;
+}
+
+__attribute__((weak)) void matrix_idle_disarm(void) {
+    for (uint8_t i = 0; i < MATRIX_IDLE_INPUTS; i++) {
+        pin_t pin = matrix_idle_input(i);
+        if (pin != NO_PIN) {
+            palDisableLineEvent(pin);
+        }
+    }
+}
+
+/** \brief Sleeps until an input goes active or MATRIX_IDLE_WAIT milliseconds have passed */
+__attribute__((weak)) void matrix_idle_wait(void) { chBSemWaitTimeout(&matrix_idle_sem, TIME_MS2I(MATRIX_IDLE_WAIT)); }
+#    else
+/** \brief Arm edge interrupts on the inputs, which must call matrix_idle_wakeup()
+ *
+ * \return false if the inputs have to be polled instead
+ */
+__attribute__((weak)) bool matrix_idle_arm(void) { return false; }
+__attribute__((weak)) void matrix_idle_disarm(void) {}
+
+/** \brief Called by matrix_scan() while armed and not woken, may sleep until matrix_idle_wakeup() */
+__attribute__((weak)) void matrix_idle_wait(void) {}
+#    endif
+
+bool matrix_is_idle(void) { return matrix_idle; }
+
+static void matrix_idle_enter(void) {
+    matrix_idle_pins(true);
+    matrix_output_select_delay();
+
+    matrix_idle_woken = false;
+    matrix_idle_armed = matrix_idle_arm();
+    matrix_idle       = true;
+
+    // catch a press that landed before the interrupts were armed
+    if (matrix_idle_armed && matrix_idle_read_pins()) {
+        matrix_idle_woken = true;
+    }
+}
+
+static void matrix_idle_exit(void) {
+    if (matrix_idle_armed) {
+        matrix_idle_disarm();
+    }
+    matrix_idle_pins(false);
+    matrix_output_unselect_delay(0, true);
+
+    matrix_idle       = false;
+    matrix_idle_timer = timer_read32();
+}
+
+/** \brief Whether this matrix_scan() has to read the matrix */
+static bool matrix_idle_should_scan(void) {
+    if (!matrix_idle) {
+        return true;
+    }
+    if (matrix_idle_armed && !matrix_idle_woken) {
+        matrix_idle_wait();
+    }
+    if (matrix_idle_armed ? matrix_idle_woken : matrix_idle_read_pins()) {
+        matrix_idle_exit();
+        return true;
+    }
+    return false;
+}
+
+static void matrix_idle_scanned(bool changed) {
+    bool active = changed;
+    for (uint8_t i = 0; i < ROWS_PER_HAND; i++) {
+#    ifdef SPLIT_KEYBOARD
+        active |= raw_matrix[i] | matrix[thisHand + i];
+#    else
+        active |= raw_matrix[i] | matrix[i];
+#    endif
+    }
+
+    if (active) {
+        matrix_idle_timer = timer_read32();
+    } else if (timer_elapsed32(matrix_idle_timer) >= MATRIX_IDLE_SCAN_TIMEOUT) {
+        matrix_idle_enter();
+    }
+}
+#endif
+
 void matrix_init(void) {
 #ifdef SPLIT_KEYBOARD
     split_pre_init();
@@ -313,7 +492,9 @@ bool matrix_post_scan(void) {
     bool changed = false;
     if (is_keyboard_master()) {
         matrix_row_t slave_matrix[ROWS_PER_HAND] = {0};
-        if (transport_master_if_connected(matrix + thisHand, slave_matrix)) {
+        bool         connected;
+        TASK_TIMING(TASK_TIMING_SPLIT, connected = transport_master_if_connected(matrix + thisHand, slave_matrix));
+        if (connected) {
             for (int i = 0; i < ROWS_PER_HAND; ++i) {
                 if (matrix[thatHand + i] != slave_matrix[i]) {
                     matrix[thatHand + i] = slave_matrix[i];
@@ -332,7 +513,7 @@ bool matrix_post_scan(void) {
 
         matrix_scan_quantum();
     } else {
-        transport_slave(matrix + thatHand, matrix + thisHand);
+        TASK_TIMING(TASK_TIMING_SPLIT, transport_slave(matrix + thatHand, matrix + thisHand));
 
         matrix_slave_scan_kb();
     }
@@ -341,7 +522,7 @@ bool matrix_post_scan(void) {
 }
 #endif
 
-uint8_t matrix_scan(void) {
+static bool matrix_read_pins(void) {
     matrix_row_t curr_matrix[MATRIX_ROWS] = {0};
 
 #if defined(DIRECT_PINS) || (DIODE_DIRECTION == COL2ROW)
@@ -358,12 +539,25 @@ uint8_t matrix_scan(void) {
 
     bool changed = memcmp(raw_matrix, curr_matrix, sizeof(curr_matrix)) != 0;
     if (changed) memcpy(raw_matrix, curr_matrix, sizeof(curr_matrix));
+    return changed;
+}
+
+uint8_t matrix_scan(void) {
+#ifdef MATRIX_IDLE_SCAN_TIMEOUT
+    bool changed = false;
+    if (matrix_idle_should_scan()) {
+        changed = matrix_read_pins();
+        matrix_idle_scanned(changed);
+    }
+#else
+    bool changed = matrix_read_pins();
+#endif
 
 #ifdef SPLIT_KEYBOARD
-    debounce(raw_matrix, matrix + thisHand, ROWS_PER_HAND, changed);
+    TASK_TIMING(TASK_TIMING_DEBOUNCE, debounce(raw_matrix, matrix + thisHand, ROWS_PER_HAND, changed));
     changed = (changed || matrix_post_scan());
 #else
-    debounce(raw_matrix, matrix, ROWS_PER_HAND, changed);
+    TASK_TIMING(TASK_TIMING_DEBOUNCE, debounce(raw_matrix, matrix, ROWS_PER_HAND, changed));
     matrix_scan_quantum();
 #endif
     return (uint8_t)changed;
@@ -60,6 +60,15 @@ void matrix_output_unselect_delay(uint8_t line, bool key_pressed);
 /* only for backwards compatibility. delay between changing matrix pin state and reading values */
 void matrix_io_delay(void);
 
+/* idle scanning, see MATRIX_IDLE_SCAN_TIMEOUT */
+bool matrix_is_idle(void);
+void matrix_idle_wakeup(void);
+void matrix_idle_pins(bool idle);
+bool matrix_idle_read_pins(void);
+bool matrix_idle_arm(void);
+void matrix_idle_disarm(void);
+void matrix_idle_wait(void);
+
 /* power control */
 void matrix_power_up(void);
 void matrix_power_down(void);
@@ -50,6 +50,9 @@ static uint16_t timer                 = 0;
 #endif
 static bool     b_combo_enable        = true;  // defaults to enabled
 static uint16_t longest_term          = 0;
+#ifdef COMBO_KEYCODE_INDEX
+static bool combo_state_dirty = false;  // some combo state may need resetting
+#endif
 
 typedef struct {
     keyrecord_t record;
@@ -96,12 +99,12 @@ static queued_combo_t combo_buffer[COMBO_BUFFER_LENGTH];
 #    define RESET_COMBO_STATE(combo) do {combo->state &= ~0x7F;}while(0)
 #endif
 
-static inline void release_combo(uint16_t combo_index, combo_t *combo) {
+static inline void release_combo(uint16_t combo_index, combo_t *combo, uint16_t time) {
     if (combo->keycode) {
         keyrecord_t record = {
             .event = {
                 .key = COMBO_KEY_POS,
-                .time = timer_read()|1,
+                .time = time,
                 .pressed = false,
             },
             .keycode = combo->keycode,
@@ -155,11 +158,25 @@ static inline uint16_t _get_combo_term(uint16_t combo_index, combo_t *combo) {
 void clear_combos(void) {
     uint16_t index = 0;
     longest_term = 0;
+#ifdef COMBO_KEYCODE_INDEX
+    // with the index, events only visit the combos containing their key, so
+    // don't scan all combos again unless one of them was touched
+    if (!combo_state_dirty) {
+        return;
+    }
+    // active combos keep their state until released, so check them again then
+    combo_state_dirty = false;
+#endif
     for (index = 0; index < COMBO_LEN; ++index) {
         combo_t *combo = &key_combos[index];
         if (!COMBO_ACTIVE(combo)) {
             RESET_COMBO_STATE(combo);
         }
+#ifdef COMBO_KEYCODE_INDEX
+        else {
+            combo_state_dirty = true;
+        }
+#endif
     }
 }
 
@@ -344,6 +361,10 @@ static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *
         return false;
     }
 
+#ifdef COMBO_KEYCODE_INDEX
+    combo_state_dirty = true;
+#endif
+
     bool key_is_part_of_combo = !COMBO_DISABLED(combo) && is_combo_enabled();
 
     if (record->event.pressed && key_is_part_of_combo) {
@@ -360,7 +381,7 @@ static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *
 
 #ifndef COMBO_NO_TIMER
             /* Don't buffer this combo if its combo term has passed. */
-            if (timer && timer_elapsed(timer) > time) {
+            if (timer && TIMER_DIFF_16(record->event.time, timer) > time) {
                 DISABLE_COMBO(combo);
                 return true;
             } else
@@ -419,7 +440,7 @@ static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *
                 apply_combos(); // also apply other prepared combos and dump key buffer
 #    ifdef COMBO_PROCESS_KEY_RELEASE
                 if (process_combo_key_release(combo_index, combo, key_index, keycode)) {
-                    release_combo(combo_index, combo);
+                    release_combo(combo_index, combo, record->event.time);
                 }
 #    endif
             }
@@ -429,7 +450,7 @@ static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *
                 && KEY_NOT_YET_RELEASED(COMBO_STATE(combo), key_index)
                 ) {
             /* last key released */
-            release_combo(combo_index, combo);
+            release_combo(combo_index, combo, record->event.time);
             key_is_part_of_combo = true;
 
 #ifdef COMBO_PROCESS_KEY_RELEASE
@@ -443,7 +464,7 @@ static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *
 
 #ifdef COMBO_PROCESS_KEY_RELEASE
             if (process_combo_key_release(combo_index, combo, key_index, keycode)) {
-                release_combo(combo_index, combo);
+                release_combo(combo_index, combo, record->event.time);
             }
 #endif
         } else {
@@ -457,9 +478,99 @@ static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *
     return key_is_part_of_combo;
 }
 
+#ifdef COMBO_KEYCODE_INDEX
+#    ifndef COMBO_KEYCODE_INDEX_SIZE
+#        ifdef COMBO_COUNT
+#            define COMBO_KEYCODE_INDEX_SIZE (COMBO_COUNT * 3)
+#        else
+#            error "COMBO_KEYCODE_INDEX_SIZE must be defined when COMBO_COUNT is not"
+#        endif
+#    endif
+
+/* Every (keycode, combo) pair of key_combos, sorted by keycode and then combo
+ * index, so the combos containing a keycode are one contiguous run that is in
+ * the same order as a scan over key_combos. */
+static uint16_t combo_index_keycodes[COMBO_KEYCODE_INDEX_SIZE];
+static uint16_t combo_index_combos[COMBO_KEYCODE_INDEX_SIZE];
+static uint16_t combo_index_size  = 0;
+static bool     combo_index_built = false;
+static bool     combo_index_valid = false;
+
+/** \brief Builds the keycode to combo index from key_combos
+ *
+ * Falls back to scanning all combos if there are more combo keys than COMBO_KEYCODE_INDEX_SIZE.
+ */
+static void combo_index_build(void) {
+    combo_index_built = true;
+    combo_index_valid = false;
+    combo_index_size  = 0;
+
+    for (uint16_t combo_index = 0; combo_index < COMBO_LEN; ++combo_index) {
+        const uint16_t *keys = key_combos[combo_index].keys;
+        uint16_t        key;
+        for (uint8_t i = 0; (key = pgm_read_word(&keys[i])) != COMBO_END; ++i) {
+            // a key listed twice must not process the combo twice
+            bool seen = false;
+            for (uint8_t j = 0; j < i; ++j) {
+                if (pgm_read_word(&keys[j]) == key) {
+                    seen = true;
+                    break;
+                }
+            }
+            if (seen) {
+                continue;
+            }
+            if (combo_index_size >= COMBO_KEYCODE_INDEX_SIZE) {
+                dprintf("combo: more than %u combo keys, not indexing combos\n", COMBO_KEYCODE_INDEX_SIZE);
+                return;
+            }
+            combo_index_keycodes[combo_index_size] = key;
+            combo_index_combos[combo_index_size]   = combo_index;
+            combo_index_size++;
+        }
+    }
+
+    // shell sort, the index is built once and can be several hundred entries long
+    for (uint16_t gap = combo_index_size / 2; gap > 0; gap /= 2) {
+        for (uint16_t i = gap; i < combo_index_size; ++i) {
+            uint16_t keycode = combo_index_keycodes[i];
+            uint16_t combo   = combo_index_combos[i];
+            uint16_t j       = i;
+            for (; j >= gap && (combo_index_keycodes[j - gap] > keycode || (combo_index_keycodes[j - gap] == keycode && combo_index_combos[j - gap] > combo)); j -= gap) {
+                combo_index_keycodes[j] = combo_index_keycodes[j - gap];
+                combo_index_combos[j]   = combo_index_combos[j - gap];
+            }
+            combo_index_keycodes[j] = keycode;
+            combo_index_combos[j]   = combo;
+        }
+    }
+
+    combo_index_valid = true;
+}
+
+/** \brief Returns the position of the first index entry for keycode, or combo_index_size */
+static uint16_t combo_index_find(uint16_t keycode) {
+    uint16_t lo = 0, hi = combo_index_size;
+    while (lo < hi) {
+        uint16_t mid = lo + (hi - lo) / 2;
+        if (combo_index_keycodes[mid] < keycode) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/** \brief Rebuilds the keycode index on the next key event
+ *
+ * The index is a copy of the keys in key_combos, so it has to be rebuilt whenever they change.
+ */
+void combo_index_rebuild(void) { combo_index_built = false; }
+#endif
+
 bool process_combo(uint16_t keycode, keyrecord_t *record) {
-    bool is_combo_key          = false;
-    bool no_combo_keys_pressed = true;
+    bool is_combo_key = false;
 
     if (keycode == CMB_ON && record->event.pressed) {
         combo_enable();
@@ -481,10 +592,23 @@ bool process_combo(uint16_t keycode, keyrecord_t *record) {
     keycode = keymap_key_to_keycode(COMBO_ONLY_FROM_LAYER, record->event.key);
 #endif
 
-    for (uint16_t idx = 0; idx < COMBO_LEN; ++idx) {
-        combo_t *combo = &key_combos[idx];
-        is_combo_key |= process_single_combo(combo, keycode, record, idx);
-        no_combo_keys_pressed = no_combo_keys_pressed && (NO_COMBO_KEYS_ARE_DOWN || COMBO_ACTIVE(combo) || COMBO_DISABLED(combo));
+#ifdef COMBO_KEYCODE_INDEX
+    if (!combo_index_built) {
+        combo_index_build();
+    }
+    if (combo_index_valid) {
+        // only the combos that contain this keycode
+        for (uint16_t i = combo_index_find(keycode); i < combo_index_size && combo_index_keycodes[i] == keycode; ++i) {
+            uint16_t idx = combo_index_combos[i];
+            is_combo_key |= process_single_combo(&key_combos[idx], keycode, record, idx);
+        }
+    } else
+#endif
+    {
+        for (uint16_t idx = 0; idx < COMBO_LEN; ++idx) {
+            combo_t *combo = &key_combos[idx];
+            is_combo_key |= process_single_combo(combo, keycode, record, idx);
+        }
     }
 
     if (record->event.pressed && is_combo_key) {
@@ -492,10 +616,10 @@ bool process_combo(uint16_t keycode, keyrecord_t *record) {
 #   ifdef COMBO_STRICT_TIMER
         if (!timer) {
             // timer is set only on the first key
-            timer = timer_read();
+            timer = record->event.time;
         }
 #   else
-        timer = timer_read();
+        timer = record->event.time;
 #   endif
 #endif
 
@@ -120,6 +120,10 @@ __attribute__((weak)) void post_process_record_user(uint16_t keycode, keyrecord_
 
 void reset_keyboard(void) {
     clear_keyboard();
+#if defined(DYNAMIC_KEYMAP_ENABLE) && defined(DYNAMIC_KEYMAP_RAM_CACHE)
+    // write pending keymap changes before the bootloader takes over
+    dynamic_keymap_flush();
+#endif
 #if defined(MIDI_ENABLE) && defined(MIDI_BASIC)
     process_midi_all_notes_off();
 #endif
@@ -193,6 +197,195 @@ void post_process_record_quantum(keyrecord_t *record) {
     post_process_record_kb(keycode, record);
 }
 
+#ifdef PROCESS_RECORD_DISPATCH
+#    if defined(RGBLIGHT_ENABLE) || defined(RGB_MATRIX_ENABLE)
+static bool process_rgb_handler(uint16_t keycode, keyrecord_t *record) { return process_rgb(keycode, record); }
+#    endif
+
+typedef bool (*process_record_handler_t)(uint16_t keycode, keyrecord_t *record);
+
+/* A handler of process_record_quantum() and the keycodes it acts on. Handlers
+ * that also act on other keycodes, e.g. to record or interrupt on them, must
+ * use PROCESS_ALL_KEYCODES.
+ */
+typedef struct {
+    process_record_handler_t handler;
+    uint16_t                 ranges[2][2];  // inclusive {first, last} keycode ranges, {1, 0} if unused
+} process_record_handler_entry_t;
+
+#    define PROCESS_ALL_KEYCODES(handler) \
+    { handler, {{0, 0xFFFF}, {1, 0}} }
+#    define PROCESS_KEYCODES(handler, first, last) \
+    { handler, {{first, last}, {1, 0}} }
+#    define PROCESS_KEYCODES2(handler, first, last, first2, last2) \
+    { handler, {{first, last}, {first2, last2}} }
+
+/* Handlers in the order they run, until one of them returns false. Keep in
+ * step with the chain in process_record_quantum() used without the dispatcher. */
+static const process_record_handler_entry_t PROGMEM process_record_handlers_table[] = {
+#    if defined(DYNAMIC_MACRO_ENABLE) && !defined(DYNAMIC_MACRO_USER_CALL)
+    // Must run asap to ensure all keypresses are recorded.
+    PROCESS_ALL_KEYCODES(process_dynamic_macro),
+#    endif
+#    if defined(AUDIO_ENABLE) && defined(AUDIO_CLICKY)
+    PROCESS_ALL_KEYCODES(process_clicky),
+#    endif
+#    ifdef HAPTIC_ENABLE
+    PROCESS_ALL_KEYCODES(process_haptic),
+#    endif
+#    if defined(VIA_ENABLE)
+    PROCESS_KEYCODES(process_record_via, FN_MO13, MACRO15),
+#    endif
+    PROCESS_ALL_KEYCODES(process_record_kb),
+#    if defined(SEQUENCER_ENABLE)
+    PROCESS_KEYCODES(process_sequencer, SQ_ON, SEQUENCER_TRACK_MAX),
+#    endif
+#    if defined(MIDI_ENABLE) && defined(MIDI_ADVANCED)
+    PROCESS_KEYCODES(process_midi, MI_ON, MI_BENDU),
+#    endif
+#    ifdef AUDIO_ENABLE
+    PROCESS_KEYCODES2(process_audio, AU_ON, AU_TOG, MUV_IN, MUV_DE),
+#    endif
+#    if defined(BACKLIGHT_ENABLE) || defined(LED_MATRIX_ENABLE)
+    PROCESS_KEYCODES(process_backlight, BL_ON, BL_BRTG),
+#    endif
+#    ifdef STENO_ENABLE
+    PROCESS_KEYCODES(process_steno, QK_STENO, QK_STENO_MAX),
+#    endif
+#    if (defined(AUDIO_ENABLE) || (defined(MIDI_ENABLE) && defined(MIDI_BASIC))) && !defined(NO_MUSIC_MODE)
+    PROCESS_ALL_KEYCODES(process_music),
+#    endif
+#    ifdef KEY_OVERRIDE_ENABLE
+    PROCESS_ALL_KEYCODES(process_key_override),
+#    endif
+#    ifdef TAP_DANCE_ENABLE
+    PROCESS_ALL_KEYCODES(process_tap_dance),
+#    endif
+#    if defined(UCIS_ENABLE)
+    PROCESS_ALL_KEYCODES(process_unicode_common),
+#    elif defined(UNICODE_ENABLE) || defined(UNICODEMAP_ENABLE)
+    PROCESS_KEYCODES2(process_unicode_common, UNICODE_MODE_FORWARD, UNICODE_MODE_WINC, QK_UNICODE, QK_UNICODE_MAX),
+#    endif
+#    ifdef LEADER_ENABLE
+    PROCESS_ALL_KEYCODES(process_leader),
+#    endif
+#    ifdef PRINTING_ENABLE
+    PROCESS_ALL_KEYCODES(process_printer),
+#    endif
+#    ifdef AUTO_SHIFT_ENABLE
+    PROCESS_ALL_KEYCODES(process_auto_shift),
+#    endif
+#    ifdef TERMINAL_ENABLE
+    PROCESS_ALL_KEYCODES(process_terminal),
+#    endif
+#    ifdef SPACE_CADET_ENABLE
+    PROCESS_ALL_KEYCODES(process_space_cadet),
+#    endif
+#    ifdef MAGIC_KEYCODE_ENABLE
+    PROCESS_KEYCODES2(process_magic, MAGIC_SWAP_CONTROL_CAPSLOCK, MAGIC_TOGGLE_ALT_GUI, MAGIC_SWAP_LCTL_LGUI, MAGIC_EE_HANDS_RIGHT),
+#    endif
+#    ifdef GRAVE_ESC_ENABLE
+    PROCESS_KEYCODES(process_grave_esc, GRAVE_ESC, GRAVE_ESC),
+#    endif
+#    if defined(RGBLIGHT_ENABLE) || defined(RGB_MATRIX_ENABLE)
+    PROCESS_KEYCODES2(process_rgb_handler, RGB_TOG, RGB_MODE_RGBTEST, RGB_MODE_TWINKLE, RGB_MODE_TWINKLE),
+#    endif
+#    ifdef JOYSTICK_ENABLE
+    PROCESS_KEYCODES(process_joystick, JS_BUTTON0, JS_BUTTON_MAX),
+#    endif
+};
+
+#    define PROCESS_RECORD_HANDLER_COUNT (sizeof(process_record_handlers_table) / sizeof(process_record_handlers_table[0]))
+
+static inline process_record_handler_t process_record_handler_at(uint8_t index) { return (process_record_handler_t)pgm_read_ptr(&process_record_handlers_table[index].handler); }
+
+_Static_assert(PROCESS_RECORD_HANDLER_COUNT <= 32, "PROCESS_RECORD_DISPATCH supports up to 32 handlers");
+
+/* The keycode space split at every range boundary of the handlers, with the
+ * handlers that act on each segment. Built on first use. */
+#    define PROCESS_RECORD_SEGMENT_MAX (PROCESS_RECORD_HANDLER_COUNT * 4 + 1)
+static uint16_t process_record_segment_start[PROCESS_RECORD_SEGMENT_MAX];
+static uint32_t process_record_segment_handlers[PROCESS_RECORD_SEGMENT_MAX];
+static uint8_t  process_record_segment_count = 0;
+
+static void process_record_segments_init(void) {
+    uint8_t count = 0;
+
+    process_record_segment_start[count++] = 0;
+    for (uint8_t i = 0; i < PROCESS_RECORD_HANDLER_COUNT; i++) {
+        for (uint8_t r = 0; r < 2; r++) {
+            uint16_t first = pgm_read_word(&process_record_handlers_table[i].ranges[r][0]);
+            uint16_t last  = pgm_read_word(&process_record_handlers_table[i].ranges[r][1]);
+            if (first > last) {
+                continue;
+            }
+            process_record_segment_start[count++] = first;
+            if (last != 0xFFFF) {
+                process_record_segment_start[count++] = last + 1;
+            }
+        }
+    }
+
+    // sort and drop duplicates
+    for (uint8_t i = 1; i < count; i++) {
+        uint16_t start = process_record_segment_start[i];
+        uint8_t  j     = i;
+        for (; j > 0 && process_record_segment_start[j - 1] > start; j--) {
+            process_record_segment_start[j] = process_record_segment_start[j - 1];
+        }
+        process_record_segment_start[j] = start;
+    }
+    uint8_t unique = 1;
+    for (uint8_t i = 1; i < count; i++) {
+        if (process_record_segment_start[i] != process_record_segment_start[unique - 1]) {
+            process_record_segment_start[unique++] = process_record_segment_start[i];
+        }
+    }
+
+    for (uint8_t s = 0; s < unique; s++) {
+        uint16_t start = process_record_segment_start[s];
+        uint32_t mask  = 0;
+        for (uint8_t i = 0; i < PROCESS_RECORD_HANDLER_COUNT; i++) {
+            for (uint8_t r = 0; r < 2; r++) {
+                if (start >= pgm_read_word(&process_record_handlers_table[i].ranges[r][0]) && start <= pgm_read_word(&process_record_handlers_table[i].ranges[r][1])) {
+                    mask |= (uint32_t)1 << i;
+                }
+            }
+        }
+        process_record_segment_handlers[s] = mask;
+    }
+    process_record_segment_count = unique;
+}
+
+static uint32_t process_record_segment_lookup(uint16_t keycode) {
+    if (!process_record_segment_count) {
+        process_record_segments_init();
+    }
+    // last segment starting at or below keycode, the first one starts at 0
+    uint8_t lo = 0, hi = process_record_segment_count - 1;
+    while (lo < hi) {
+        uint8_t mid = (lo + hi + 1) / 2;
+        if (process_record_segment_start[mid] <= keycode) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return process_record_segment_handlers[lo];
+}
+
+/** \brief Runs the handlers whose keycode ranges contain keycode until one of them returns false */
+static bool process_record_handlers(uint16_t keycode, keyrecord_t *record) {
+    uint32_t handlers = process_record_segment_lookup(keycode);
+    for (uint8_t i = 0; handlers; i++, handlers >>= 1) {
+        if ((handlers & 1) && !process_record_handler_at(i)(keycode, record)) {
+            return false;
+        }
+    }
+    return true;
+}
+#endif  // PROCESS_RECORD_DISPATCH
+
 /* Core keycode function, hands off handling to other functions,
     then processes internal quantum keycodes, and then processes
     ACTIONs.                                                      */
@@ -223,82 +416,95 @@ bool process_record_quantum(keyrecord_t *record) {
     preprocess_tap_dance(keycode, record);
 #endif
 
+#ifdef PROCESS_RECORD_DISPATCH
+#    if defined(KEY_LOCK_ENABLE)
+    // Must run first to be able to mask key_up events.
+    if (!process_key_lock(&keycode, record)) {
+        return false;
+    }
+#    endif
+
+    if (!process_record_handlers(keycode, record)) {
+        return false;
+    }
+#else
     if (!(
-#if defined(KEY_LOCK_ENABLE)
+#    if defined(KEY_LOCK_ENABLE)
             // Must run first to be able to mask key_up events.
             process_key_lock(&keycode, record) &&
-#endif
-#if defined(DYNAMIC_MACRO_ENABLE) && !defined(DYNAMIC_MACRO_USER_CALL)
+#    endif
+#    if defined(DYNAMIC_MACRO_ENABLE) && !defined(DYNAMIC_MACRO_USER_CALL)
             // Must run asap to ensure all keypresses are recorded.
             process_dynamic_macro(keycode, record) &&
-#endif
-#if defined(AUDIO_ENABLE) && defined(AUDIO_CLICKY)
+#    endif
+#    if defined(AUDIO_ENABLE) && defined(AUDIO_CLICKY)
             process_clicky(keycode, record) &&
-#endif
-#ifdef HAPTIC_ENABLE
+#    endif
+#    ifdef HAPTIC_ENABLE
             process_haptic(keycode, record) &&
-#endif
-#if defined(VIA_ENABLE)
+#    endif
+#    if defined(VIA_ENABLE)
             process_record_via(keycode, record) &&
-#endif
+#    endif
             process_record_kb(keycode, record) &&
-#if defined(SEQUENCER_ENABLE)
+#    if defined(SEQUENCER_ENABLE)
             process_sequencer(keycode, record) &&
-#endif
-#if defined(MIDI_ENABLE) && defined(MIDI_ADVANCED)
+#    endif
+#    if defined(MIDI_ENABLE) && defined(MIDI_ADVANCED)
             process_midi(keycode, record) &&
-#endif
-#ifdef AUDIO_ENABLE
+#    endif
+#    ifdef AUDIO_ENABLE
             process_audio(keycode, record) &&
-#endif
-#if defined(BACKLIGHT_ENABLE) || defined(LED_MATRIX_ENABLE)
+#    endif
+#    if defined(BACKLIGHT_ENABLE) || defined(LED_MATRIX_ENABLE)
             process_backlight(keycode, record) &&
-#endif
-#ifdef STENO_ENABLE
+#    endif
+#    ifdef STENO_ENABLE
             process_steno(keycode, record) &&
-#endif
-#if (defined(AUDIO_ENABLE) || (defined(MIDI_ENABLE) && defined(MIDI_BASIC))) && !defined(NO_MUSIC_MODE)
+#    endif
+#    if (defined(AUDIO_ENABLE) || (defined(MIDI_ENABLE) && defined(MIDI_BASIC))) && !defined(NO_MUSIC_MODE)
             process_music(keycode, record) &&
-#endif
-#ifdef KEY_OVERRIDE_ENABLE
+#    endif
+#    ifdef KEY_OVERRIDE_ENABLE
             process_key_override(keycode, record) &&
-#endif
-#ifdef TAP_DANCE_ENABLE
+#    endif
+#    ifdef TAP_DANCE_ENABLE
             process_tap_dance(keycode, record) &&
-#endif
-#if defined(UNICODE_ENABLE) || defined(UNICODEMAP_ENABLE) || defined(UCIS_ENABLE)
+#    endif
+#    if defined(UNICODE_ENABLE) || defined(UNICODEMAP_ENABLE) || defined(UCIS_ENABLE)
             process_unicode_common(keycode, record) &&
-#endif
-#ifdef LEADER_ENABLE
+#    endif
+#    ifdef LEADER_ENABLE
             process_leader(keycode, record) &&
-#endif
-#ifdef PRINTING_ENABLE
+#    endif
+#    ifdef PRINTING_ENABLE
             process_printer(keycode, record) &&
-#endif
-#ifdef AUTO_SHIFT_ENABLE
+#    endif
+#    ifdef AUTO_SHIFT_ENABLE
             process_auto_shift(keycode, record) &&
-#endif
-#ifdef TERMINAL_ENABLE
+#    endif
+#    ifdef TERMINAL_ENABLE
             process_terminal(keycode, record) &&
-#endif
-#ifdef SPACE_CADET_ENABLE
+#    endif
+#    ifdef SPACE_CADET_ENABLE
             process_space_cadet(keycode, record) &&
-#endif
-#ifdef MAGIC_KEYCODE_ENABLE
+#    endif
+#    ifdef MAGIC_KEYCODE_ENABLE
             process_magic(keycode, record) &&
-#endif
-#ifdef GRAVE_ESC_ENABLE
+#    endif
+#    ifdef GRAVE_ESC_ENABLE
             process_grave_esc(keycode, record) &&
-#endif
-#if defined(RGBLIGHT_ENABLE) || defined(RGB_MATRIX_ENABLE)
+#    endif
+#    if defined(RGBLIGHT_ENABLE) || defined(RGB_MATRIX_ENABLE)
             process_rgb(keycode, record) &&
-#endif
-#ifdef JOYSTICK_ENABLE
+#    endif
+#    ifdef JOYSTICK_ENABLE
             process_joystick(keycode, record) &&
-#endif
+#    endif
             true)) {
         return false;
     }
+#endif  // PROCESS_RECORD_DISPATCH
 
     if (record->event.pressed) {
         switch (keycode) {
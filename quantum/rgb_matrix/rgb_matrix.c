@@ -116,6 +116,24 @@ __attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) { return hsv_to_rgb(hsv
 #    define RGB_MATRIX_STARTUP_SPD UINT8_MAX / 2
 #endif
 
+#ifdef RGB_MATRIX_ASYNC_FLUSH
+#    ifndef PROTOCOL_CHIBIOS
+#        error "RGB_MATRIX_ASYNC_FLUSH is only available on ChibiOS"
+#    endif
+#    include <ch.h>
+#endif
+#ifdef RGB_MATRIX_RENDER_BUDGET_US
+#    if defined(PROTOCOL_CHIBIOS)
+#        include <ch.h>
+#    elif defined(__AVR__)
+#        include <util/atomic.h>
+#        include "timer_avr.h"
+#    endif
+#    ifndef RGB_MATRIX_FLUSH_BUDGET_PERCENT
+#        define RGB_MATRIX_FLUSH_BUDGET_PERCENT 25
+#    endif
+#endif
+
 // globals
 rgb_config_t rgb_matrix_config;  // TODO: would like to prefix this with g_ for global consistancy, do this in another pr
 uint32_t     g_rgb_timer;
@@ -125,6 +143,12 @@ uint8_t g_rgb_frame_buffer[MATRIX_ROWS][MATRIX_COLS] = {{0}};
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
 last_hit_t g_last_hit_tracker;
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+uint8_t g_led_center_dist[DRIVER_LED_TOTAL];
+#endif  // RGB_MATRIX_GEOMETRY_CACHE
+#ifdef RGB_MATRIX_RENDER_BUDGET_US
+uint8_t g_rgb_led_process_limit;
+#endif  // RGB_MATRIX_RENDER_BUDGET_US
 
 // internals
 static bool            suspend_state     = false;
@@ -143,11 +167,52 @@ static uint32_t rgb_timer_buffer;
 static last_hit_t last_hit_buffer;
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
 
+#ifdef RGB_MATRIX_RENDER_BUDGET_US
+// The averages are kept scaled up by their smoothing factor, so small differences still add up
+static uint32_t rgb_render_cost_x8   = 0;  // average cost of rendering one LED of the current effect, in 1/128 us
+static uint32_t rgb_flush_cost_us_x4 = 0;  // average duration of rgb_matrix_update_pwm_buffers(), in 1/4 us
+#endif  // RGB_MATRIX_RENDER_BUDGET_US
+
+#if defined(RGB_MATRIX_GEOMETRY_CACHE) && defined(RGB_MATRIX_KEYREACTIVE_ENABLED)
+// distance between every pair of LEDs, lower triangle without the diagonal
+static uint8_t led_pair_dist[DRIVER_LED_TOTAL * (DRIVER_LED_TOTAL - 1) / 2];
+#endif
+
 // split rgb matrix
 #if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
 const uint8_t k_rgb_matrix_split[2] = RGB_MATRIX_SPLIT;
 #endif
 
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+static uint8_t rgb_matrix_point_distance(led_point_t a, led_point_t b) {
+    int16_t dx = a.x - b.x;
+    int16_t dy = a.y - b.y;
+    return sqrt16(dx * dx + dy * dy);
+}
+
+#    ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
+static inline uint16_t led_pair_index(uint8_t a, uint8_t b) { return (uint16_t)a * (a - 1) / 2 + b; }
+
+uint8_t rgb_matrix_led_distance(uint8_t a, uint8_t b) {
+    if (a == b) {
+        return 0;
+    }
+    return a > b ? led_pair_dist[led_pair_index(a, b)] : led_pair_dist[led_pair_index(b, a)];
+}
+#    endif
+
+static void rgb_matrix_geometry_init(void) {
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        g_led_center_dist[i] = rgb_matrix_point_distance(g_led_config.point[i], k_rgb_matrix_center);
+#    ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
+        for (uint8_t j = 0; j < i; j++) {
+            led_pair_dist[led_pair_index(i, j)] = rgb_matrix_point_distance(g_led_config.point[i], g_led_config.point[j]);
+        }
+#    endif
+    }
+}
+#endif  // RGB_MATRIX_GEOMETRY_CACHE
+
 void eeconfig_read_rgb_matrix(void) { eeprom_read_block(&rgb_matrix_config, EECONFIG_RGB_MATRIX, sizeof(rgb_matrix_config)); }
 
 void eeconfig_update_rgb_matrix(void) { eeprom_update_block(&rgb_matrix_config, EECONFIG_RGB_MATRIX, sizeof(rgb_matrix_config)); }
@@ -185,7 +250,53 @@ uint8_t rgb_matrix_map_row_column_to_led(uint8_t row, uint8_t column, uint8_t *l
     return led_count;
 }
 
+#ifdef RGB_MATRIX_ASYNC_FLUSH
+// The driver flush runs on its own thread, which sleeps while the I2C peripheral
+// sends the data so the main loop keeps scanning in the meantime.
+static THD_WORKING_AREA(rgb_flush_thread_wa, 512);
+static binary_semaphore_t rgb_flush_request;
+static binary_semaphore_t rgb_flush_done;
+static volatile uint8_t   rgb_flush_requested = 0;
+static volatile uint8_t   rgb_flush_completed = 0;
+
+static THD_FUNCTION(rgb_flush_thread, arg) {
+    (void)arg;
+    chRegSetThreadName("rgb_flush");
+
+    while (true) {
+        chBSemWait(&rgb_flush_request);
+        uint8_t requested = rgb_flush_requested;
+        rgb_matrix_driver.flush();
+        rgb_flush_completed = requested;
+        chBSemSignal(&rgb_flush_done);
+    }
+}
+
+static void rgb_flush_init(void) {
+    chBSemObjectInit(&rgb_flush_request, true);
+    chBSemObjectInit(&rgb_flush_done, true);
+    // Above the main thread, so that it queues the next transfer as soon as the previous one is done
+    chThdCreateStatic(rgb_flush_thread_wa, sizeof(rgb_flush_thread_wa), NORMALPRIO + 1, rgb_flush_thread, NULL);
+}
+
+static void rgb_flush_start(void) {
+    rgb_flush_requested++;
+    chBSemSignal(&rgb_flush_request);
+}
+
+static bool rgb_flush_busy(void) { return rgb_flush_completed != rgb_flush_requested; }
+
+void rgb_matrix_update_pwm_buffers(void) {
+    // Flushing from here as well would interleave with the flush thread
+    rgb_flush_start();
+    // A completion left over from an earlier flush only makes this check again
+    while (rgb_flush_busy()) {
+        chBSemWait(&rgb_flush_done);
+    }
+}
+#else
 void rgb_matrix_update_pwm_buffers(void) { rgb_matrix_driver.flush(); }
+#endif
 
 void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
 #if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
@@ -313,16 +424,105 @@ static void rgb_task_timers(void) {
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
 }
 
+#ifdef RGB_MATRIX_RENDER_BUDGET_US
+#    if defined(PROTOCOL_CHIBIOS)
+// system ticks, CH_CFG_ST_FREQUENCY decides the resolution
+static inline uint32_t rgb_budget_read(void) { return (uint32_t)chVTGetSystemTimeX(); }
+
+static inline uint32_t rgb_budget_elapsed_us(uint32_t start) { return TIME_I2US(chTimeDiffX((systime_t)start, chVTGetSystemTimeX())); }
+#    elif defined(__AVR__)
+// milliseconds and the timer 0 count within the current one
+static uint32_t rgb_budget_read(void) {
+    uint32_t ms;
+    uint8_t  raw;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        ms  = timer_read32();
+        raw = TIMER_RAW;
+    }
+    return ms * TIMER_RAW_TOP + raw;
+}
+
+static uint32_t rgb_budget_elapsed_us(uint32_t start) {
+    uint32_t ticks = rgb_budget_read() - start;
+    // the timer interrupt may be pending while the count has already wrapped
+    if (ticks > UINT32_MAX / 2) {
+        return 0;
+    }
+    return ticks * 1000 / TIMER_RAW_TOP;
+}
+#    else
+static inline uint32_t rgb_budget_read(void) { return timer_read32(); }
+
+static inline uint32_t rgb_budget_elapsed_us(uint32_t start) { return TIMER_DIFF_32(timer_read32(), start) * 1000; }
+#    endif
+
+/** \brief Pick how many LEDs to render per task run for the next frame
+ *
+ * Until the current effect has been measured, RGB_MATRIX_LED_PROCESS_LIMIT is used.
+ */
+static void rgb_budget_start(void) {
+    uint32_t limit = RGB_MATRIX_LED_PROCESS_LIMIT;
+    if (rgb_render_cost_x8) {
+        limit = (uint32_t)RGB_MATRIX_RENDER_BUDGET_US * 16 * 8 / rgb_render_cost_x8;
+    }
+    if (limit == 0) {
+        limit = 1;
+    } else if (limit > DRIVER_LED_TOTAL) {
+        limit = DRIVER_LED_TOTAL;
+    }
+    g_rgb_led_process_limit = limit;
+}
+
+/** \brief Fold the duration of the render step that began at start into the cost per LED */
+static void rgb_budget_measure_render(uint32_t start) {
+    uint16_t first = (uint16_t)g_rgb_led_process_limit * rgb_effect_params.iter;
+    if (first >= DRIVER_LED_TOTAL) {
+        return;
+    }
+    uint16_t leds   = DRIVER_LED_TOTAL - first < g_rgb_led_process_limit ? DRIVER_LED_TOTAL - first : g_rgb_led_process_limit;
+    uint32_t sample = rgb_budget_elapsed_us(start) * 16 / leds;
+    if (sample > UINT16_MAX) {
+        sample = UINT16_MAX;
+    }
+    // the system tick may be coarser than a render step, so single samples are averaged out
+    if (rgb_render_cost_x8 == 0) {
+        rgb_render_cost_x8 = sample * 8;
+    } else {
+        rgb_render_cost_x8 += sample - (rgb_render_cost_x8 + 4) / 8;
+    }
+}
+
+/** \brief Milliseconds between frames
+ *
+ * Slow flushes cannot be split up, so frames are spaced out until flushing takes at most
+ * RGB_MATRIX_FLUSH_BUDGET_PERCENT of the time.
+ */
+static uint32_t rgb_flush_interval(void) {
+    uint32_t interval = rgb_flush_cost_us_x4 * 100 / (RGB_MATRIX_FLUSH_BUDGET_PERCENT * 1000 * 4);
+    return interval > RGB_MATRIX_LED_FLUSH_LIMIT ? interval : RGB_MATRIX_LED_FLUSH_LIMIT;
+}
+#else
+#    define rgb_flush_interval() RGB_MATRIX_LED_FLUSH_LIMIT
+#endif  // RGB_MATRIX_RENDER_BUDGET_US
+
 static void rgb_task_sync(void) {
+#ifdef RGB_MATRIX_ASYNC_FLUSH
+    // don't render the next frame into the buffers while the flush thread is still sending them
+    if (rgb_flush_busy()) return;
+#endif
+
     // next task
     if (rgb_update_eeprom) eeconfig_update_rgb_matrix();
     rgb_update_eeprom = false;
-    if (sync_timer_elapsed32(g_rgb_timer) >= RGB_MATRIX_LED_FLUSH_LIMIT) rgb_task_state = STARTING;
+    if (sync_timer_elapsed32(g_rgb_timer) >= rgb_flush_interval()) rgb_task_state = STARTING;
 }
 
 static void rgb_task_start(void) {
     // reset iter
     rgb_effect_params.iter = 0;
+#ifdef RGB_MATRIX_RENDER_BUDGET_US
+    rgb_budget_start();
+#endif
 
     // update double buffers
     g_rgb_timer = rgb_timer_buffer;
@@ -341,6 +541,13 @@ static void rgb_task_render(uint8_t effect) {
         rgb_effect_params.flags = rgb_matrix_config.flags;
         rgb_matrix_set_color_all(0, 0, 0);
     }
+#ifdef RGB_MATRIX_RENDER_BUDGET_US
+    // a different effect has a different cost per LED
+    if (rgb_effect_params.init && rgb_effect_params.iter == 0) {
+        rgb_render_cost_x8 = 0;
+    }
+    uint32_t render_start = rgb_budget_read();
+#endif
 
     // each effect can opt to do calculations
     // and/or request PWM buffer updates.
@@ -382,6 +589,9 @@ static void rgb_task_render(uint8_t effect) {
             return;
     }
 
+#ifdef RGB_MATRIX_RENDER_BUDGET_US
+    rgb_budget_measure_render(render_start);
+#endif
     rgb_effect_params.iter++;
 
     // next task
@@ -400,7 +610,19 @@ static void rgb_task_flush(uint8_t effect) {
     rgb_last_enable = rgb_matrix_config.enable;
 
     // update pwm buffers
+#ifdef RGB_MATRIX_ASYNC_FLUSH
+    rgb_flush_start();
+#elif defined(RGB_MATRIX_RENDER_BUDGET_US)
+    uint32_t flush_start = rgb_budget_read();
+    rgb_matrix_update_pwm_buffers();
+    uint32_t flush_us = rgb_budget_elapsed_us(flush_start);
+    if (flush_us > UINT16_MAX) {
+        flush_us = UINT16_MAX;
+    }
+    rgb_flush_cost_us_x4 += flush_us - (rgb_flush_cost_us_x4 + 2) / 4;
+#else
     rgb_matrix_update_pwm_buffers();
+#endif
 
     // next task
     rgb_task_state = SYNCING;
@@ -454,7 +676,11 @@ void rgb_matrix_indicators_advanced(effect_params_t *params) {
      * and not sure which would be better. Otherwise, this should be called from
      * rgb_task_render, right before the iter++ line.
      */
-#if defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
+#ifdef RGB_MATRIX_RENDER_BUDGET_US
+    uint8_t min = g_rgb_led_process_limit * (params->iter - 1);
+    uint8_t max = DRIVER_LED_TOTAL;
+    if (min + g_rgb_led_process_limit < DRIVER_LED_TOTAL) max = min + g_rgb_led_process_limit;
+#elif defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
     uint8_t min = RGB_MATRIX_LED_PROCESS_LIMIT * (params->iter - 1);
     uint8_t max = min + RGB_MATRIX_LED_PROCESS_LIMIT;
     if (max > DRIVER_LED_TOTAL) max = DRIVER_LED_TOTAL;
@@ -472,6 +698,12 @@ __attribute__((weak)) void rgb_matrix_indicators_advanced_user(uint8_t led_min,
 
 void rgb_matrix_init(void) {
     rgb_matrix_driver.init();
+#ifdef RGB_MATRIX_ASYNC_FLUSH
+    rgb_flush_init();
+#endif
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+    rgb_matrix_geometry_init();
+#endif
 
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
     g_last_hit_tracker.count = 0;
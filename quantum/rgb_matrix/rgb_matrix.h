@@ -47,7 +47,20 @@
 #    define RGB_MATRIX_LED_PROCESS_LIMIT (DRIVER_LED_TOTAL + 4) / 5
 #endif
 
-#if defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
+#ifdef RGB_MATRIX_RENDER_BUDGET_US
+// number of LEDs rendered per task run, picked every frame to fit the budget
+extern uint8_t g_rgb_led_process_limit;
+#    define RGB_MATRIX_LED_PROCESS_CHUNK g_rgb_led_process_limit
+#else
+#    define RGB_MATRIX_LED_PROCESS_CHUNK (RGB_MATRIX_LED_PROCESS_LIMIT)
+#endif
+
+#ifdef RGB_MATRIX_RENDER_BUDGET_US
+#    define RGB_MATRIX_USE_LIMITS(min, max)                   \
+        uint8_t min = g_rgb_led_process_limit * params->iter; \
+        uint8_t max = DRIVER_LED_TOTAL;                       \
+        if (min + g_rgb_led_process_limit < DRIVER_LED_TOTAL) max = min + g_rgb_led_process_limit;
+#elif defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
 #    define RGB_MATRIX_USE_LIMITS(min, max)                        \
         uint8_t min = RGB_MATRIX_LED_PROCESS_LIMIT * params->iter; \
         uint8_t max = min + RGB_MATRIX_LED_PROCESS_LIMIT;          \
@@ -223,6 +236,12 @@ extern led_config_t g_led_config;
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
 extern last_hit_t g_last_hit_tracker;
 #endif
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+extern uint8_t g_led_center_dist[DRIVER_LED_TOTAL];
+#    ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
+uint8_t rgb_matrix_led_distance(uint8_t a, uint8_t b);
+#    endif
+#endif
 #ifdef RGB_MATRIX_FRAMEBUFFER_EFFECTS
 extern uint8_t g_rgb_frame_buffer[MATRIX_ROWS][MATRIX_COLS];
 #endif
@@ -24,6 +24,10 @@ enum serial_transaction_id {
     GET_SLAVE_MATRIX_CHECKSUM,
     GET_SLAVE_MATRIX_DATA,
 
+#ifdef SPLIT_MATRIX_DELTA
+    GET_SLAVE_MATRIX_DELTA,
+#endif  // SPLIT_MATRIX_DELTA
+
 #ifdef SPLIT_TRANSPORT_MIRROR
     PUT_MASTER_MATRIX,
 #endif  // SPLIT_TRANSPORT_MIRROR
@@ -82,6 +86,9 @@ enum serial_transaction_id {
     PUT_RPC_INFO,
     PUT_RPC_REQ_DATA,
     EXECUTE_RPC,
+#    ifdef SPLIT_RPC_STREAM_ENABLE
+    PUT_RPC_STREAM,
+#    endif  // SPLIT_RPC_STREAM_ENABLE
     GET_RPC_RESP_DATA,
 #endif  // defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
 
@@ -98,5 +105,10 @@ enum serial_transaction_id {
     NUM_TOTAL_TRANSACTIONS
 };
 
-// Ensure we only use 5 bits for transaction
+#if defined(__AVR__) && defined(SERIAL_DRIVER_BITBANG) && !defined(USE_I2C)
+// The AVR bitbang driver sends the transaction ID in 5 bits, followed by 3 bits of checksum
 _Static_assert(NUM_TOTAL_TRANSACTIONS <= (1 << 5), "Max number of usable transactions exceeded");
+#else
+// The other transports send the transaction ID as a whole byte, and it is passed around as int8_t
+_Static_assert(NUM_TOTAL_TRANSACTIONS <= (1 << 7), "Max number of usable transactions exceeded");
+#endif
@@ -42,6 +42,9 @@
     { &dummy, 0, 0, sizeof_member(split_shared_memory_t, member), offsetof(split_shared_memory_t, member), cb }
 #define trans_target2initiator_initializer(member) trans_target2initiator_initializer_cb(member, NULL)
 
+#define trans_bidirectional_initializer_cb(initiator2target_member, target2initiator_member, cb) \
+    { &dummy, sizeof_member(split_shared_memory_t, initiator2target_member), offsetof(split_shared_memory_t, initiator2target_member), sizeof_member(split_shared_memory_t, target2initiator_member), offsetof(split_shared_memory_t, target2initiator_member), cb }
+
 #define transport_write(id, data, length)          transport_execute_transaction(id, data, length, NULL, 0)
 #define transport_read(id, data, length)           transport_execute_transaction(id, NULL, 0, data, length)
 
@@ -63,7 +66,13 @@ static bool transaction_handler_master(matrix_row_t master_matrix[], matrix_row_
             }
         }
         bool this_okay = true;
+#ifdef SERIAL_USART_PIPELINE
+        // The pipelined USART transport waits on the serial driver queues, which can't be done with
+        // interrupts disabled. The master's shared memory is only used from this thread anyway.
+        this_okay = handler(master_matrix, slave_matrix);
+#else
         ATOMIC_BLOCK_FORCEON { this_okay = handler(master_matrix, slave_matrix); };
+#endif
         if (this_okay) return true;
     }
     dprintf("Failed to execute %s\n", prefix);
@@ -95,12 +104,102 @@ inline static bool read_if_checksum_mismatch(int8_t trans_id_checksum, int8_t tr
     return okay;
 }
 
+#ifdef SPLIT_TRANSACTION_BUDGET
+
+#    ifndef SPLIT_TRANSACTION_COSMETIC_PERIOD_MS
+#        define SPLIT_TRANSACTION_COSMETIC_PERIOD_MS 20
+#    endif  // SPLIT_TRANSACTION_COSMETIC_PERIOD_MS
+
+typedef struct {
+    bool    deferrable;  // may wait for a later scan once this scan's budget is used up
+    uint8_t min_period;  // minimum number of milliseconds between two sends
+} split_transaction_schedule_t;
+
+// Transactions not listed here are never deferred: the slave matrix, encoders, the master matrix
+// mirror and the sync timer go out whenever they need to. They also run first, as transactions_master()
+// handles everything in priority order.
+// clang-format off
+static const split_transaction_schedule_t PROGMEM split_transaction_schedule[NUM_TOTAL_TRANSACTIONS] = {
+#    if !defined(NO_ACTION_LAYER) && defined(SPLIT_LAYER_STATE_ENABLE)
+    [PUT_LAYER_STATE]         = {true, 0},
+    [PUT_DEFAULT_LAYER_STATE] = {true, 0},
+#    endif
+#    ifdef SPLIT_LED_STATE_ENABLE
+    [PUT_LED_STATE]           = {true, 0},
+#    endif
+#    ifdef SPLIT_MODS_ENABLE
+    [PUT_MODS]                = {true, 0},
+#    endif
+#    ifdef BACKLIGHT_ENABLE
+    [PUT_BACKLIGHT]           = {true, SPLIT_TRANSACTION_COSMETIC_PERIOD_MS},
+#    endif
+#    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+    [PUT_RGBLIGHT]            = {true, SPLIT_TRANSACTION_COSMETIC_PERIOD_MS},
+#    endif
+#    if defined(LED_MATRIX_ENABLE) && defined(LED_MATRIX_SPLIT)
+    [PUT_LED_MATRIX]          = {true, SPLIT_TRANSACTION_COSMETIC_PERIOD_MS},
+#    endif
+#    if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
+    [PUT_RGB_MATRIX]          = {true, SPLIT_TRANSACTION_COSMETIC_PERIOD_MS},
+#    endif
+#    if defined(WPM_ENABLE) && defined(SPLIT_WPM_ENABLE)
+    [PUT_WPM]                 = {true, SPLIT_TRANSACTION_COSMETIC_PERIOD_MS},
+#    endif
+#    if defined(OLED_ENABLE) && defined(SPLIT_OLED_ENABLE)
+    [PUT_OLED]                = {true, SPLIT_TRANSACTION_COSMETIC_PERIOD_MS},
+#    endif
+#    if defined(ST7565_ENABLE) && defined(SPLIT_ST7565_ENABLE)
+    [PUT_ST7565]              = {true, SPLIT_TRANSACTION_COSMETIC_PERIOD_MS},
+#    endif
+#    if (defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)) && defined(SPLIT_RPC_STREAM_ENABLE)
+    [PUT_RPC_STREAM]          = {true, 0},
+#    endif
+};
+// clang-format on
+
+static uint16_t transaction_budget;
+static uint16_t transaction_last_sent[NUM_TOTAL_TRANSACTIONS];
+
+/** \brief Whether a transaction has to wait for a later scan
+ *
+ * Deferred transactions keep their "needs sending" condition, so their handler simply sends
+ * them in the first scan that has room, spreading low priority traffic over idle scans.
+ */
+static bool transaction_deferred(int8_t trans_id, size_t length) {
+    split_transaction_schedule_t schedule;
+    memcpy_P(&schedule, &split_transaction_schedule[trans_id], sizeof(schedule));
+    if (!schedule.deferrable) {
+        return false;
+    }
+    if (timer_elapsed(transaction_last_sent[trans_id]) < schedule.min_period) {
+        return true;
+    }
+    // Something larger than the whole budget still goes out on its own
+    return length > transaction_budget && transaction_budget < SPLIT_TRANSACTION_BUDGET;
+}
+
+static void transaction_charge(int8_t trans_id, size_t length) {
+    transaction_budget              = length < transaction_budget ? transaction_budget - length : 0;
+    transaction_last_sent[trans_id] = timer_read();
+}
+
+#else  // SPLIT_TRANSACTION_BUDGET
+
+#    define transaction_deferred(trans_id, length) false
+#    define transaction_charge(trans_id, length)
+
+#endif  // SPLIT_TRANSACTION_BUDGET
+
 inline static bool send_if_condition(int8_t trans_id, uint32_t *last_update, bool condition, void *source, size_t length) {
     bool okay = true;
     if (timer_elapsed32(*last_update) >= FORCED_SYNC_THROTTLE_MS || condition) {
+        if (transaction_deferred(trans_id, length)) {
+            return true;
+        }
         okay &= transport_write(trans_id, source, length);
         if (okay) {
             *last_update = timer_read32();
+            transaction_charge(trans_id, length);
         }
     }
     return okay;
@@ -114,6 +213,153 @@ inline static bool send_if_data_mismatch(int8_t trans_id, uint32_t *last_update,
 ////////////////////////////////////////////////////
 // Slave matrix
 
+#ifdef SPLIT_MATRIX_DELTA
+
+#    ifndef SPLIT_MATRIX_DELTA_QUEUE_SIZE
+#        define SPLIT_MATRIX_DELTA_QUEUE_SIZE 32
+#    endif  // SPLIT_MATRIX_DELTA_QUEUE_SIZE
+
+// Sequence numbers are compared modulo 256
+_Static_assert(SPLIT_MATRIX_DELTA_QUEUE_SIZE < 128, "SPLIT_MATRIX_DELTA_QUEUE_SIZE must be less than 128");
+_Static_assert(SPLIT_MATRIX_DELTA_EVENTS <= SPLIT_MATRIX_DELTA_QUEUE_SIZE, "SPLIT_MATRIX_DELTA_EVENTS must not exceed SPLIT_MATRIX_DELTA_QUEUE_SIZE");
+
+// Slave side: key changes the master hasn't acknowledged yet, oldest first
+static struct {
+    uint8_t              seq;  // sequence number of the event at head
+    uint8_t              head;
+    uint8_t              count;
+    split_matrix_event_t events[SPLIT_MATRIX_DELTA_QUEUE_SIZE];
+} delta_queue;
+
+// Must be called with interrupts disabled, slave_matrix_delta_callback() works on the same queue
+static void slave_matrix_delta_push(uint8_t row, uint8_t col, bool pressed) {
+    if (delta_queue.count == SPLIT_MATRIX_DELTA_QUEUE_SIZE) {
+        // The master has fallen too far behind to catch up event by event. Skipping the sequence
+        // numbers of the dropped events makes it notice the gap and fetch the whole matrix instead.
+        delta_queue.seq += delta_queue.count;
+        delta_queue.head  = 0;
+        delta_queue.count = 0;
+    }
+    delta_queue.events[(delta_queue.head + delta_queue.count) % SPLIT_MATRIX_DELTA_QUEUE_SIZE] = (split_matrix_event_t){.row = row, .col = col, .pressed = pressed};
+    delta_queue.count++;
+}
+
+static void slave_matrix_delta_callback(uint8_t initiator2target_buffer_size, const void *initiator2target_buffer, uint8_t target2initiator_buffer_size, void *target2initiator_buffer) {
+    // Everything before the master's acknowledgement has been applied, drop it
+    uint8_t acked = *(const uint8_t *)initiator2target_buffer - delta_queue.seq;
+    if (acked <= delta_queue.count) {
+        delta_queue.seq += acked;
+        delta_queue.head  = (delta_queue.head + acked) % SPLIT_MATRIX_DELTA_QUEUE_SIZE;
+        delta_queue.count -= acked;
+    }
+
+    // Send the oldest events; anything the master doesn't acknowledge next time is sent again
+    split_slave_matrix_delta_t *delta = (split_slave_matrix_delta_t *)target2initiator_buffer;
+    delta->seq                        = delta_queue.seq;
+    delta->pending                    = delta_queue.count;
+    delta->count                      = delta_queue.count < SPLIT_MATRIX_DELTA_EVENTS ? delta_queue.count : SPLIT_MATRIX_DELTA_EVENTS;
+    delta->checksum                   = split_shmem->smatrix.checksum;
+    for (uint8_t i = 0; i < delta->count; i++) {
+        delta->events[i] = delta_queue.events[(delta_queue.head + i) % SPLIT_MATRIX_DELTA_QUEUE_SIZE];
+    }
+}
+
+static bool slave_matrix_handlers_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    static matrix_row_t last_matrix[(MATRIX_ROWS) / 2] = {0};  // slave matrix rebuilt from the events applied so far
+    static uint8_t      next_seq                       = 0;    // sequence number of the next event to apply, acknowledges the ones before it
+    static bool         synced                         = false;
+    split_slave_matrix_delta_t delta;
+
+    bool okay = transport_execute_transaction(GET_SLAVE_MATRIX_DELTA, &next_seq, sizeof(next_seq), &delta, sizeof(delta));
+    if (okay) {
+        // Events before next_seq have been applied already. They are sent again when the slave handled an
+        // older acknowledgement, e.g. with the AVR bitbang driver, which runs the slave callback before
+        // receiving the master's data.
+        uint8_t skip = next_seq - delta.seq;
+        if (synced && skip <= delta.count) {
+            // Apply at most one change per key, so that a tap that happened between two transactions
+            // still shows up as a press and a release; the rest is sent again with the next transaction
+            matrix_row_t changed[(MATRIX_ROWS) / 2] = {0};
+            uint8_t      applied                    = skip;
+            for (; applied < delta.count && applied < SPLIT_MATRIX_DELTA_EVENTS; applied++) {
+                split_matrix_event_t event = delta.events[applied];
+                matrix_row_t         mask  = MATRIX_ROW_SHIFTER << event.col;
+                if (event.row >= (MATRIX_ROWS) / 2) {
+                    synced = false;
+                    break;
+                }
+                if (changed[event.row] & mask) {
+                    break;
+                }
+                changed[event.row] |= mask;
+                if (event.pressed) {
+                    last_matrix[event.row] |= mask;
+                } else {
+                    last_matrix[event.row] &= ~mask;
+                }
+            }
+            next_seq = delta.seq + applied;
+
+            // Once caught up, the checksum confirms the rebuilt matrix; this replaces the forced periodic sync
+            if (synced && applied == delta.pending && delta.checksum != crc8(last_matrix, sizeof(last_matrix))) {
+                synced = false;
+            }
+        } else {
+            // First transaction, slave restart or events dropped on the slave
+            synced = false;
+        }
+
+        if (!synced) {
+            okay = transport_read(GET_SLAVE_MATRIX_DATA, last_matrix, sizeof(last_matrix));
+            if (okay) {
+                // The fetched matrix already includes every pending event. Later events may be applied
+                // again, which is harmless as they set a key state instead of toggling it.
+                next_seq = delta.seq + delta.pending;
+                synced   = true;
+            }
+        }
+    }
+    // Copy out the last-known-good matrix state to the slave matrix
+    memcpy(slave_matrix, last_matrix, sizeof(last_matrix));
+    return okay;
+}
+
+static void slave_matrix_handlers_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    // Only this handler writes smatrix.matrix, so the changes can be found without locking
+    matrix_row_t changes[(MATRIX_ROWS) / 2];
+    for (uint8_t row = 0; row < (MATRIX_ROWS) / 2; row++) {
+        changes[row] = slave_matrix[row] ^ split_shmem->smatrix.matrix[row];
+    }
+    uint8_t checksum = crc8(slave_matrix, sizeof(split_shmem->smatrix.matrix));
+
+    // slave_matrix_delta_callback() and the matrix reads run from the transport's interrupt or
+    // thread, so the queued events, the matrix and its checksum have to change together
+    ATOMIC_BLOCK_FORCEON {
+        for (uint8_t row = 0; row < (MATRIX_ROWS) / 2; row++) {
+            matrix_row_t row_changes = changes[row];
+            for (uint8_t col = 0; row_changes; col++, row_changes >>= 1) {
+                if (row_changes & 1) {
+                    slave_matrix_delta_push(row, col, slave_matrix[row] & (MATRIX_ROW_SHIFTER << col));
+                }
+            }
+        }
+        memcpy(split_shmem->smatrix.matrix, slave_matrix, sizeof(split_shmem->smatrix.matrix));
+        split_shmem->smatrix.checksum = checksum;
+    };
+}
+
+// clang-format off
+#    define TRANSACTIONS_SLAVE_MATRIX_MASTER() TRANSACTION_HANDLER_MASTER(slave_matrix)
+// locks only around the shared memory update, see slave_matrix_handlers_slave()
+#    define TRANSACTIONS_SLAVE_MATRIX_SLAVE() slave_matrix_handlers_slave(master_matrix, slave_matrix)
+#    define TRANSACTIONS_SLAVE_MATRIX_REGISTRATIONS \
+    [GET_SLAVE_MATRIX_CHECKSUM] = trans_target2initiator_initializer(smatrix.checksum), \
+    [GET_SLAVE_MATRIX_DATA]     = trans_target2initiator_initializer(smatrix.matrix), \
+    [GET_SLAVE_MATRIX_DELTA]    = trans_bidirectional_initializer_cb(smatrix_delta.ack, smatrix_delta.delta, slave_matrix_delta_callback),
+// clang-format on
+
+#else  // SPLIT_MATRIX_DELTA
+
 static bool slave_matrix_handlers_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
     static uint32_t     last_update                    = 0;
     static matrix_row_t last_matrix[(MATRIX_ROWS) / 2] = {0};  // last successfully-read matrix, so we can replicate if there are checksum errors
@@ -135,13 +381,15 @@ static void slave_matrix_handlers_slave(matrix_row_t master_matrix[], matrix_row
 }
 
 // clang-format off
-#define TRANSACTIONS_SLAVE_MATRIX_MASTER() TRANSACTION_HANDLER_MASTER(slave_matrix)
-#define TRANSACTIONS_SLAVE_MATRIX_SLAVE() TRANSACTION_HANDLER_SLAVE(slave_matrix)
-#define TRANSACTIONS_SLAVE_MATRIX_REGISTRATIONS \
+#    define TRANSACTIONS_SLAVE_MATRIX_MASTER() TRANSACTION_HANDLER_MASTER(slave_matrix)
+#    define TRANSACTIONS_SLAVE_MATRIX_SLAVE() TRANSACTION_HANDLER_SLAVE(slave_matrix)
+#    define TRANSACTIONS_SLAVE_MATRIX_REGISTRATIONS \
     [GET_SLAVE_MATRIX_CHECKSUM] = trans_target2initiator_initializer(smatrix.checksum), \
     [GET_SLAVE_MATRIX_DATA]     = trans_target2initiator_initializer(smatrix.matrix),
 // clang-format on
 
+#endif  // SPLIT_MATRIX_DELTA
+
 ////////////////////////////////////////////////////
 // Master matrix
 
@@ -339,10 +587,11 @@ static bool mods_handlers_master(matrix_row_t master_matrix[], matrix_row_t slav
 #    endif  // NO_ACTION_ONESHOT
 
     bool okay = true;
-    if (mods_need_sync) {
+    if (mods_need_sync && !transaction_deferred(PUT_MODS, sizeof(new_mods))) {
         okay &= transport_write(PUT_MODS, &new_mods, sizeof(new_mods));
         if (okay) {
             last_update = timer_read32();
+            transaction_charge(PUT_MODS, sizeof(new_mods));
         }
     }
 
@@ -403,6 +652,10 @@ static bool rgblight_handlers_master(matrix_row_t master_matrix[], matrix_row_t
     static uint32_t     last_update = 0;
     rgblight_syncinfo_t rgblight_sync;
     rgblight_get_syncinfo(&rgblight_sync);
+    // Keep the change flags until the changes have actually been sent
+    if (transaction_deferred(PUT_RGBLIGHT, sizeof(rgblight_sync))) {
+        return true;
+    }
     if (send_if_condition(PUT_RGBLIGHT, &last_update, (rgblight_sync.status.change_flags != 0), &rgblight_sync, sizeof(rgblight_sync))) {
         rgblight_clear_change_flags();
     } else {
@@ -578,6 +831,182 @@ static void st7565_handlers_slave(matrix_row_t master_matrix[], matrix_row_t sla
 
 #endif  // defined(ST7565_ENABLE) && defined(SPLIT_ST7565_ENABLE)
 
+////////////////////////////////////////////////////
+// RPC streaming
+
+#if (defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)) && defined(SPLIT_RPC_STREAM_ENABLE)
+
+#    ifndef RPC_STREAM_FRAGMENTS_PER_SCAN
+#        define RPC_STREAM_FRAGMENTS_PER_SCAN 1
+#    endif  // RPC_STREAM_FRAGMENTS_PER_SCAN
+
+#    ifndef RPC_STREAM_MAX_RETRIES
+#        define RPC_STREAM_MAX_RETRIES 100
+#    endif  // RPC_STREAM_MAX_RETRIES
+
+#    ifndef MIN
+#        define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#    endif
+
+// Acknowledgement of a stream the slave can't take, the master drops it
+#    define RPC_STREAM_REJECTED UINT16_MAX
+
+#    define NUM_RPC_TRANSACTIONS (NUM_TOTAL_TRANSACTIONS - GET_RPC_RESP_DATA - 1)
+
+// Master side: the stream being sent, the data stays owned by the caller until it's done
+static struct {
+    const uint8_t *data;
+    uint16_t       length;
+    uint16_t       sent;
+    int8_t         transaction_id;
+    uint8_t        stream_id;
+    uint8_t        retries;  // acks in a row that were for another stream
+} rpc_stream_tx;
+
+// Slave side: where each stream is reassembled, and the stream being received
+static struct {
+    uint8_t *             buffer;
+    uint16_t              buffer_size;
+    rpc_stream_callback_t callback;
+} rpc_stream_targets[NUM_RPC_TRANSACTIONS];
+
+static struct {
+    int8_t        transaction_id;
+    uint8_t       stream_id;
+    uint16_t      received;
+    uint16_t      total_length;
+    volatile bool complete;  // waiting to be handed over to the callback, no new stream is accepted until then
+} rpc_stream_rx = {.received = RPC_STREAM_REJECTED};  // nothing to continue until a stream starts
+
+void transaction_register_rpc_stream(int8_t transaction_id, void *buffer, uint16_t buffer_size, rpc_stream_callback_t callback) {
+    // Prevent invoking RPC on QMK core sync data
+    if (transaction_id <= GET_RPC_RESP_DATA || transaction_id >= NUM_TOTAL_TRANSACTIONS) return;
+
+    rpc_stream_targets[transaction_id - GET_RPC_RESP_DATA - 1].buffer      = buffer;
+    rpc_stream_targets[transaction_id - GET_RPC_RESP_DATA - 1].buffer_size = buffer_size;
+    rpc_stream_targets[transaction_id - GET_RPC_RESP_DATA - 1].callback    = callback;
+}
+
+bool transaction_rpc_stream(int8_t transaction_id, uint16_t length, const void *data) {
+    // Prevent transaction attempts while transport is disconnected
+    if (!is_transport_connected()) return false;
+    // Prevent invoking RPC on QMK core sync data
+    if (transaction_id <= GET_RPC_RESP_DATA || transaction_id >= NUM_TOTAL_TRANSACTIONS) return false;
+    // One stream at a time
+    if (transaction_rpc_stream_busy() || length == 0 || length == RPC_STREAM_REJECTED) return false;
+
+    rpc_stream_tx.data           = data;
+    rpc_stream_tx.length         = length;
+    rpc_stream_tx.sent           = 0;
+    rpc_stream_tx.transaction_id = transaction_id;
+    rpc_stream_tx.retries        = 0;
+    // A freshly started slave acks stream 0, so that one is never used
+    if (++rpc_stream_tx.stream_id == 0) {
+        rpc_stream_tx.stream_id = 1;
+    }
+    return true;
+}
+
+bool transaction_rpc_stream_busy(void) { return rpc_stream_tx.data != NULL; }
+
+static bool rpc_stream_handlers_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    for (uint8_t i = 0; i < RPC_STREAM_FRAGMENTS_PER_SCAN && rpc_stream_tx.data; i++) {
+        rpc_stream_fragment_t fragment = {
+            .transaction_id = rpc_stream_tx.transaction_id,
+            .stream_id      = rpc_stream_tx.stream_id,
+            .offset         = rpc_stream_tx.sent,
+            .total_length   = rpc_stream_tx.length,
+            .length         = MIN(rpc_stream_tx.length - rpc_stream_tx.sent, RPC_STREAM_FRAGMENT_SIZE),
+        };
+        memcpy(fragment.data, rpc_stream_tx.data + fragment.offset, fragment.length);
+
+        if (transaction_deferred(PUT_RPC_STREAM, sizeof(fragment))) {
+            return true;
+        }
+
+        rpc_stream_ack_t ack;
+        if (!transport_execute_transaction(PUT_RPC_STREAM, &fragment, sizeof(fragment), &ack, sizeof(ack))) {
+            return false;
+        }
+        transaction_charge(PUT_RPC_STREAM, sizeof(fragment));
+
+        if (ack.stream_id != fragment.stream_id) {
+            // Either the slave is still busy with the previous stream, or it was restarted and lost
+            // this one. Start over so it can pick the stream up again, unless that keeps failing.
+            if (++rpc_stream_tx.retries >= RPC_STREAM_MAX_RETRIES) {
+                dprintf("RPC stream %d not acknowledged\n", fragment.transaction_id);
+                rpc_stream_tx.data = NULL;
+            }
+            rpc_stream_tx.sent = 0;
+            return true;
+        }
+        rpc_stream_tx.retries = 0;
+        if (ack.received == RPC_STREAM_REJECTED) {
+            dprintf("RPC stream %d rejected\n", fragment.transaction_id);
+            rpc_stream_tx.data = NULL;
+            return true;
+        }
+
+        // Continue wherever the slave is, which also resends a fragment it didn't get
+        rpc_stream_tx.sent = MIN(ack.received, rpc_stream_tx.length);
+        if (rpc_stream_tx.sent == rpc_stream_tx.length) {
+            rpc_stream_tx.data = NULL;
+        } else if (rpc_stream_tx.sent < fragment.offset + fragment.length) {
+            return true;
+        }
+    }
+    return true;
+}
+
+static void rpc_stream_callback(uint8_t initiator2target_buffer_size, const void *initiator2target_buffer, uint8_t target2initiator_buffer_size, void *target2initiator_buffer) {
+    const rpc_stream_fragment_t *fragment = (const rpc_stream_fragment_t *)initiator2target_buffer;
+    rpc_stream_ack_t *           ack      = (rpc_stream_ack_t *)target2initiator_buffer;
+
+    if (!rpc_stream_rx.complete) {
+        if (fragment->offset == 0 && fragment->stream_id != rpc_stream_rx.stream_id) {
+            // A new stream, check that it fits where it's supposed to go
+            int8_t transaction_id        = fragment->transaction_id;
+            rpc_stream_rx.stream_id      = fragment->stream_id;
+            rpc_stream_rx.transaction_id = transaction_id;
+            rpc_stream_rx.total_length   = fragment->total_length;
+            rpc_stream_rx.received       = 0;
+            if (transaction_id <= GET_RPC_RESP_DATA || transaction_id >= NUM_TOTAL_TRANSACTIONS || !rpc_stream_targets[transaction_id - GET_RPC_RESP_DATA - 1].callback || fragment->total_length > rpc_stream_targets[transaction_id - GET_RPC_RESP_DATA - 1].buffer_size) {
+                rpc_stream_rx.received = RPC_STREAM_REJECTED;
+            }
+        }
+
+        // Only the fragment that continues where the last one ended is taken, anything else is a resend
+        if (fragment->stream_id == rpc_stream_rx.stream_id && fragment->offset == rpc_stream_rx.received && fragment->length <= RPC_STREAM_FRAGMENT_SIZE && fragment->offset + fragment->length <= rpc_stream_rx.total_length) {
+            memcpy(rpc_stream_targets[rpc_stream_rx.transaction_id - GET_RPC_RESP_DATA - 1].buffer + fragment->offset, fragment->data, fragment->length);
+            rpc_stream_rx.received += fragment->length;
+            rpc_stream_rx.complete = rpc_stream_rx.received == rpc_stream_rx.total_length;
+        }
+    }
+
+    ack->stream_id = rpc_stream_rx.stream_id;
+    ack->received  = rpc_stream_rx.received;
+}
+
+static void rpc_stream_handlers_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    // Not in an atomic block, the buffer is left alone until complete is cleared
+    if (rpc_stream_rx.complete) {
+        rpc_stream_targets[rpc_stream_rx.transaction_id - GET_RPC_RESP_DATA - 1].callback(rpc_stream_rx.total_length, rpc_stream_targets[rpc_stream_rx.transaction_id - GET_RPC_RESP_DATA - 1].buffer);
+        rpc_stream_rx.complete = false;
+    }
+}
+
+#    define TRANSACTIONS_RPC_STREAM_MASTER()      TRANSACTION_HANDLER_MASTER(rpc_stream)
+#    define TRANSACTIONS_RPC_STREAM_SLAVE()       rpc_stream_handlers_slave(master_matrix, slave_matrix)
+#    define TRANSACTIONS_RPC_STREAM_REGISTRATIONS [PUT_RPC_STREAM] = trans_bidirectional_initializer_cb(rpc_stream.fragment, rpc_stream.ack, rpc_stream_callback),
+
+#else  // (defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)) && defined(SPLIT_RPC_STREAM_ENABLE)
+
+#    define TRANSACTIONS_RPC_STREAM_MASTER()
+#    define TRANSACTIONS_RPC_STREAM_SLAVE()
+#    define TRANSACTIONS_RPC_STREAM_REGISTRATIONS
+
+#endif  // (defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)) && defined(SPLIT_RPC_STREAM_ENABLE)
+
 ////////////////////////////////////////////////////
 
 uint8_t                  dummy;
@@ -604,6 +1033,7 @@ split_transaction_desc_t split_transaction_table[NUM_TOTAL_TRANSACTIONS] = {
     TRANSACTIONS_WPM_REGISTRATIONS
     TRANSACTIONS_OLED_REGISTRATIONS
     TRANSACTIONS_ST7565_REGISTRATIONS
+    TRANSACTIONS_RPC_STREAM_REGISTRATIONS
 // clang-format on
 
 #if defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
@@ -615,6 +1045,9 @@ split_transaction_desc_t split_transaction_table[NUM_TOTAL_TRANSACTIONS] = {
 };
 
 bool transactions_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+#ifdef SPLIT_TRANSACTION_BUDGET
+    transaction_budget = SPLIT_TRANSACTION_BUDGET;
+#endif  // SPLIT_TRANSACTION_BUDGET
     TRANSACTIONS_SLAVE_MATRIX_MASTER();
     TRANSACTIONS_MASTER_MATRIX_MASTER();
     TRANSACTIONS_ENCODERS_MASTER();
@@ -629,6 +1062,7 @@ bool transactions_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix
     TRANSACTIONS_WPM_MASTER();
     TRANSACTIONS_OLED_MASTER();
     TRANSACTIONS_ST7565_MASTER();
+    TRANSACTIONS_RPC_STREAM_MASTER();
     return true;
 }
 
@@ -647,6 +1081,7 @@ void transactions_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[
     TRANSACTIONS_WPM_SLAVE();
     TRANSACTIONS_OLED_SLAVE();
     TRANSACTIONS_ST7565_SLAVE();
+    TRANSACTIONS_RPC_STREAM_SLAVE();
 }
 
 #if defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
@@ -52,3 +52,12 @@ bool transaction_rpc_exec(int8_t transaction_id, uint8_t initiator2target_buffer
 
 #define transaction_rpc_send(transaction_id, initiator2target_buffer_size, initiator2target_buffer) transaction_rpc_exec(transaction_id, initiator2target_buffer_size, initiator2target_buffer, 0, NULL)
 #define transaction_rpc_recv(transaction_id, target2initiator_buffer_size, target2initiator_buffer) transaction_rpc_exec(transaction_id, 0, NULL, target2initiator_buffer_size, target2initiator_buffer)
+
+#ifdef SPLIT_RPC_STREAM_ENABLE
+typedef void (*rpc_stream_callback_t)(uint16_t length, const void *data);
+
+void transaction_register_rpc_stream(int8_t transaction_id, void *buffer, uint16_t buffer_size, rpc_stream_callback_t callback);
+
+bool transaction_rpc_stream(int8_t transaction_id, uint16_t length, const void *data);
+bool transaction_rpc_stream_busy(void);
+#endif  // SPLIT_RPC_STREAM_ENABLE
@@ -31,6 +31,10 @@
 #    define RPC_S2M_BUFFER_SIZE 32
 #endif  // RPC_S2M_BUFFER_SIZE
 
+#ifndef RPC_STREAM_FRAGMENT_SIZE
+#    define RPC_STREAM_FRAGMENT_SIZE 16
+#endif  // RPC_STREAM_FRAGMENT_SIZE
+
 void transport_master_init(void);
 void transport_slave_init(void);
 
@@ -58,6 +62,31 @@ typedef struct _split_slave_matrix_sync_t {
     matrix_row_t matrix[(MATRIX_ROWS) / 2];
 } split_slave_matrix_sync_t;
 
+#ifdef SPLIT_MATRIX_DELTA
+#    ifndef SPLIT_MATRIX_DELTA_EVENTS
+#        define SPLIT_MATRIX_DELTA_EVENTS 4
+#    endif  // SPLIT_MATRIX_DELTA_EVENTS
+
+typedef struct _split_matrix_event_t {
+    uint8_t row;
+    uint8_t col : 7;
+    uint8_t pressed : 1;
+} split_matrix_event_t;
+
+typedef struct _split_slave_matrix_delta_t {
+    uint8_t              seq;       // sequence number of events[0]
+    uint8_t              count;     // number of events sent
+    uint8_t              pending;   // number of events not acknowledged yet, including the ones sent
+    uint8_t              checksum;  // checksum of the slave matrix with every pending event applied
+    split_matrix_event_t events[SPLIT_MATRIX_DELTA_EVENTS];
+} split_slave_matrix_delta_t;
+
+typedef struct _split_slave_matrix_delta_sync_t {
+    uint8_t                    ack;  // sequence number of the next event the master expects
+    split_slave_matrix_delta_t delta;
+} split_slave_matrix_delta_sync_t;
+#endif  // SPLIT_MATRIX_DELTA
+
 #ifdef SPLIT_TRANSPORT_MIRROR
 typedef struct _split_master_matrix_sync_t {
     matrix_row_t matrix[(MATRIX_ROWS) / 2];
@@ -112,6 +141,27 @@ typedef struct _rpc_sync_info_t {
     uint8_t m2s_length;
     uint8_t s2m_length;
 } rpc_sync_info_t;
+
+#    ifdef SPLIT_RPC_STREAM_ENABLE
+typedef struct _rpc_stream_fragment_t {
+    int8_t   transaction_id;
+    uint8_t  stream_id;  // changes with every stream, so a new one can be told apart from a resent fragment
+    uint16_t offset;
+    uint16_t total_length;
+    uint8_t  length;
+    uint8_t  data[RPC_STREAM_FRAGMENT_SIZE];
+} rpc_stream_fragment_t;
+
+typedef struct _rpc_stream_ack_t {
+    uint8_t  stream_id;  // stream the slave is receiving or still handing over
+    uint16_t received;   // bytes of it received so far, where the next fragment has to start
+} rpc_stream_ack_t;
+
+typedef struct _rpc_stream_sync_t {
+    rpc_stream_fragment_t fragment;
+    rpc_stream_ack_t      ack;
+} rpc_stream_sync_t;
+#    endif  // SPLIT_RPC_STREAM_ENABLE
 #endif  // defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
 
 typedef struct _split_shared_memory_t {
@@ -121,6 +171,10 @@ typedef struct _split_shared_memory_t {
 
     split_slave_matrix_sync_t smatrix;
 
+#ifdef SPLIT_MATRIX_DELTA
+    split_slave_matrix_delta_sync_t smatrix_delta;
+#endif  // SPLIT_MATRIX_DELTA
+
 #ifdef SPLIT_TRANSPORT_MIRROR
     split_master_matrix_sync_t mmatrix;
 #endif  // SPLIT_TRANSPORT_MIRROR
@@ -177,6 +231,9 @@ typedef struct _split_shared_memory_t {
     rpc_sync_info_t rpc_info;
     uint8_t         rpc_m2s_buffer[RPC_M2S_BUFFER_SIZE];
     uint8_t         rpc_s2m_buffer[RPC_S2M_BUFFER_SIZE];
+#    ifdef SPLIT_RPC_STREAM_ENABLE
+    rpc_stream_sync_t rpc_stream;
+#    endif  // SPLIT_RPC_STREAM_ENABLE
 #endif  // defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
 } split_shared_memory_t;
 
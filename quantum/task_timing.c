@@ -0,0 +1,200 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "task_timing.h"
+#include "timer.h"
+#include "debug.h"
+#include <string.h>
+
+#if defined(PROTOCOL_CHIBIOS)
+#    include <ch.h>
+#elif defined(__AVR__)
+#    include <avr/io.h>
+#    include <util/atomic.h>
+#    include "timer_avr.h"
+#endif
+
+static task_timing_stats_t task_timing_stats[TASK_TIMING_COUNT];
+static uint16_t            task_timing_ring[TASK_TIMING_RING_SIZE];
+static uint8_t             task_timing_ring_head  = 0;
+static uint8_t             task_timing_ring_count = 0;
+
+#if defined(PROTOCOL_CHIBIOS)
+/* System ticks, CH_CFG_ST_FREQUENCY decides the resolution */
+__attribute__((weak)) uint32_t task_timing_read(void) { return (uint32_t)chVTGetSystemTimeX(); }
+
+__attribute__((weak)) uint32_t task_timing_elapsed_us(uint32_t start) { return TIME_I2US(chTimeDiffX((systime_t)start, chVTGetSystemTimeX())); }
+#elif defined(__AVR__)
+/* Milliseconds and the timer 0 count within the current one */
+__attribute__((weak)) uint32_t task_timing_read(void) {
+    uint32_t ms;
+    uint8_t  raw;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        ms  = timer_read32();
+        raw = TIMER_RAW;
+    }
+    return ms * TIMER_RAW_TOP + raw;
+}
+
+__attribute__((weak)) uint32_t task_timing_elapsed_us(uint32_t start) {
+    uint32_t ticks = task_timing_read() - start;
+    // the timer interrupt may be pending while the count has already wrapped
+    if (ticks > UINT32_MAX / 2) {
+        return 0;
+    }
+    return ticks * 1000 / TIMER_RAW_TOP;
+}
+#else
+__attribute__((weak)) uint32_t task_timing_read(void) { return timer_read32(); }
+
+__attribute__((weak)) uint32_t task_timing_elapsed_us(uint32_t start) { return TIMER_DIFF_32(timer_read32(), start) * 1000; }
+#endif
+
+#ifdef CONSOLE_ENABLE
+static uint16_t task_timing_window = 0;
+
+static const char *const task_timing_names[TASK_TIMING_COUNT] = {
+    [TASK_TIMING_SCAN]            = "scan",
+    [TASK_TIMING_MATRIX_SCAN]     = "matrix_scan",
+    [TASK_TIMING_DEBOUNCE]        = "debounce",
+    [TASK_TIMING_SPLIT]           = "split",
+    [TASK_TIMING_ACTION]          = "action",
+    [TASK_TIMING_RGBLIGHT]        = "rgblight",
+    [TASK_TIMING_LED_MATRIX]      = "led_matrix",
+    [TASK_TIMING_RGB_MATRIX]      = "rgb_matrix",
+    [TASK_TIMING_BACKLIGHT]       = "backlight",
+    [TASK_TIMING_ENCODER]         = "encoder",
+    [TASK_TIMING_QWIIC]           = "qwiic",
+    [TASK_TIMING_OLED]            = "oled",
+    [TASK_TIMING_ST7565]          = "st7565",
+    [TASK_TIMING_MOUSEKEY]        = "mousekey",
+    [TASK_TIMING_POINTING_DEVICE] = "pointing_device",
+    [TASK_TIMING_MIDI]            = "midi",
+    [TASK_TIMING_JOYSTICK]        = "joystick",
+    [TASK_TIMING_DIGITIZER]       = "digitizer",
+    [TASK_TIMING_OTHER]           = "other",
+};
+#endif
+
+/** \brief Adds the time since start to the statistics of task */
+void task_timing_record(task_timing_task_t task, uint32_t start) {
+    uint32_t elapsed = task_timing_elapsed_us(start);
+    uint16_t us      = elapsed > UINT16_MAX ? UINT16_MAX : elapsed;
+
+    task_timing_stats_t *stats = &task_timing_stats[task];
+    if (stats->count == UINT16_MAX) {
+        return;
+    }
+    if (!stats->count || us < stats->min_us) {
+        stats->min_us = us;
+    }
+    if (us > stats->max_us) {
+        stats->max_us = us;
+    }
+    stats->count++;
+    stats->total_us += us;
+
+    uint8_t  bucket = 0;
+    uint16_t scaled = us >> TASK_TIMING_HISTOGRAM_SHIFT;
+    while (scaled && bucket < TASK_TIMING_HISTOGRAM_SIZE - 1) {
+        scaled >>= 1;
+        bucket++;
+    }
+    stats->histogram[bucket]++;
+
+    if (task == TASK_TIMING_SCAN) {
+        task_timing_ring[task_timing_ring_head] = us;
+        task_timing_ring_head                   = (task_timing_ring_head + 1) % TASK_TIMING_RING_SIZE;
+        if (task_timing_ring_count < TASK_TIMING_RING_SIZE) {
+            task_timing_ring_count++;
+        }
+    }
+}
+
+/** \brief Statistics of task since the last reset */
+const task_timing_stats_t *task_timing_get_stats(task_timing_task_t task) { return task < TASK_TIMING_COUNT ? &task_timing_stats[task] : NULL; }
+
+/** \brief Copies the durations of the most recent scans, newest first
+ *
+ * \return the number of scans copied
+ */
+uint8_t task_timing_get_recent_scans(uint16_t *scans_us, uint8_t count) {
+    if (count > task_timing_ring_count) {
+        count = task_timing_ring_count;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        scans_us[i] = task_timing_ring[(task_timing_ring_head + TASK_TIMING_RING_SIZE - 1 - i) % TASK_TIMING_RING_SIZE];
+    }
+    return count;
+}
+
+void task_timing_reset(void) {
+    memset(task_timing_stats, 0, sizeof(task_timing_stats));
+    task_timing_ring_count = 0;
+    task_timing_ring_head  = 0;
+}
+
+/** \brief Prints and resets the statistics every TASK_TIMING_REPORT_INTERVAL ms
+ *
+ * Without the console, the statistics are kept until task_timing_reset().
+ */
+void task_timing_task(void) {
+#ifdef CONSOLE_ENABLE
+    if (timer_elapsed(task_timing_window) < TASK_TIMING_REPORT_INTERVAL) {
+        return;
+    }
+    for (uint8_t task = 0; task < TASK_TIMING_COUNT; task++) {
+        const task_timing_stats_t *stats = &task_timing_stats[task];
+        if (!stats->count) {
+            continue;
+        }
+        dprintf("task timing %s: n:%u min:%u avg:%lu max:%u us |", task_timing_names[task], stats->count, stats->min_us, (unsigned long)(stats->total_us / stats->count), stats->max_us);
+        for (uint8_t bucket = 0; bucket < TASK_TIMING_HISTOGRAM_SIZE; bucket++) {
+            dprintf(" %u", stats->histogram[bucket]);
+        }
+        dprintf("\n");
+    }
+    task_timing_reset();
+    task_timing_window = timer_read();
+#endif
+}
+
+/** \brief Answers a raw HID request for the statistics of one task
+ *
+ * data[1] is the task, the reply starts at data[2] with the call count, min,
+ * average and max in us and the histogram, all 16 bit big endian.
+ *
+ * \return false if the task doesn't exist or the reply doesn't fit
+ */
+bool task_timing_raw_hid(uint8_t *data, uint8_t length) {
+    if (length < 2 || data[1] >= TASK_TIMING_COUNT || length < 2 + (4 + TASK_TIMING_HISTOGRAM_SIZE) * 2) {
+        return false;
+    }
+    const task_timing_stats_t *stats = &task_timing_stats[data[1]];
+    uint16_t                   values[4 + TASK_TIMING_HISTOGRAM_SIZE];
+    values[0] = stats->count;
+    values[1] = stats->min_us;
+    values[2] = stats->count ? stats->total_us / stats->count : 0;
+    values[3] = stats->max_us;
+    memcpy(&values[4], stats->histogram, sizeof(stats->histogram));
+
+    uint8_t *reply = &data[2];
+    for (uint8_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        *reply++ = values[i] >> 8;
+        *reply++ = values[i] & 0xFF;
+    }
+    return true;
+}
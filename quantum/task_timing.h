@@ -0,0 +1,98 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Stages of keyboard_task() whose duration is measured. matrix_scan includes
+ * debounce and, on split keyboards, the split transactions. */
+typedef enum {
+    TASK_TIMING_SCAN = 0, /* the whole of keyboard_task() */
+    TASK_TIMING_MATRIX_SCAN,
+    TASK_TIMING_DEBOUNCE,
+    TASK_TIMING_SPLIT,
+    TASK_TIMING_ACTION,
+    TASK_TIMING_RGBLIGHT,
+    TASK_TIMING_LED_MATRIX,
+    TASK_TIMING_RGB_MATRIX,
+    TASK_TIMING_BACKLIGHT,
+    TASK_TIMING_ENCODER,
+    TASK_TIMING_QWIIC,
+    TASK_TIMING_OLED,
+    TASK_TIMING_ST7565,
+    TASK_TIMING_MOUSEKEY,
+    TASK_TIMING_POINTING_DEVICE,
+    TASK_TIMING_MIDI,
+    TASK_TIMING_JOYSTICK,
+    TASK_TIMING_DIGITIZER,
+    TASK_TIMING_OTHER, /* everything else keyboard_task() calls */
+    TASK_TIMING_COUNT,
+} task_timing_task_t;
+
+#ifndef TASK_TIMING_HISTOGRAM_SIZE
+#    define TASK_TIMING_HISTOGRAM_SIZE 8
+#endif
+/* Bucket 0 counts durations below 2^TASK_TIMING_HISTOGRAM_SHIFT us, every
+ * following bucket twice that, and the last one everything above. */
+#ifndef TASK_TIMING_HISTOGRAM_SHIFT
+#    define TASK_TIMING_HISTOGRAM_SHIFT 4
+#endif
+#ifndef TASK_TIMING_RING_SIZE
+#    define TASK_TIMING_RING_SIZE 16
+#endif
+#ifndef TASK_TIMING_REPORT_INTERVAL
+#    define TASK_TIMING_REPORT_INTERVAL 1000
+#endif
+
+typedef struct {
+    uint16_t count;
+    uint16_t min_us;
+    uint16_t max_us;
+    uint32_t total_us;
+    uint16_t histogram[TASK_TIMING_HISTOGRAM_SIZE];
+} task_timing_stats_t;
+
+#ifdef TASK_TIMING_ENABLE
+/* Platform time stamp and the microseconds elapsed since one, weak so that
+ * keyboards can use a finer timer. */
+uint32_t task_timing_read(void);
+uint32_t task_timing_elapsed_us(uint32_t start);
+
+void                       task_timing_record(task_timing_task_t task, uint32_t start);
+const task_timing_stats_t *task_timing_get_stats(task_timing_task_t task);
+uint8_t                    task_timing_get_recent_scans(uint16_t *scans_us, uint8_t count);
+void                       task_timing_reset(void);
+void                       task_timing_task(void);
+bool                       task_timing_raw_hid(uint8_t *data, uint8_t length);
+
+#    define TASK_TIMING_START(start) uint32_t start = task_timing_read()
+#    define TASK_TIMING_STOP(task, start) task_timing_record(task, start)
+#    define TASK_TIMING(task, ...)                          \
+        do {                                                \
+            uint32_t task_timing_start_ = task_timing_read(); \
+            __VA_ARGS__;                                    \
+            task_timing_record(task, task_timing_start_);   \
+        } while (0)
+#else
+#    define TASK_TIMING_START(start)
+#    define TASK_TIMING_STOP(task, start)
+#    define TASK_TIMING(task, ...) \
+        do {                       \
+            __VA_ARGS__;           \
+        } while (0)
+#endif
@@ -0,0 +1,24 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Builds keymap_common.c without ACTION_KEYCODE_TABLE, with the switch based
+ * action_for_keycode() renamed so both can be linked into the test. The other
+ * functions in the file are weak, so the duplicates are discarded.
+ */
+#undef ACTION_KEYCODE_TABLE
+#define action_for_key action_for_key_switch
+#define action_for_keycode action_for_keycode_switch
+#include "keymap_common.c"
@@ -0,0 +1,71 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "quantum.h"
+
+action_t action_for_keycode_switch(uint16_t keycode);
+}
+
+class ActionKeycodeTable : public testing::Test {
+   public:
+    void SetUp() override { saved_config = keymap_config; }
+    void TearDown() override { keymap_config = saved_config; }
+
+    // compares every keycode, returns the number of mismatches
+    unsigned compare_all_keycodes(void) {
+        unsigned mismatches = 0;
+        for (uint32_t keycode = 0; keycode <= 0xFFFF; keycode++) {
+            uint16_t expected = action_for_keycode_switch(keycode).code;
+            uint16_t actual   = action_for_keycode(keycode).code;
+            if (expected != actual && mismatches++ < 10) {
+                ADD_FAILURE() << "keycode 0x" << std::hex << keycode << ": table gives 0x" << actual << ", switch gives 0x" << expected << " (keymap_config 0x" << keymap_config.raw << ")";
+            }
+        }
+        return mismatches;
+    }
+
+    keymap_config_t saved_config;
+};
+
+TEST_F(ActionKeycodeTable, BasicKeycodesMatchSwitch) {
+    keymap_config.raw = 0;
+    for (uint16_t keycode = 0; keycode <= QK_BASIC_MAX; keycode++) {
+        EXPECT_EQ(action_for_keycode(keycode).code, action_for_keycode_switch(keycode).code) << "keycode 0x" << std::hex << keycode;
+    }
+}
+
+TEST_F(ActionKeycodeTable, AllKeycodesMatchSwitchForEveryRemapping) {
+    // every combination of the low keymap_config bits, which hold all the ones
+    // keycode_config() and mod_config() look at
+    for (uint16_t bits = 0; bits < (1 << 10); bits++) {
+        keymap_config_t config          = {.raw = 0};
+        config.swap_control_capslock    = bits & (1 << 0);
+        config.capslock_to_control      = bits & (1 << 1);
+        config.swap_lalt_lgui           = bits & (1 << 2);
+        config.swap_ralt_rgui           = bits & (1 << 3);
+        config.no_gui                   = bits & (1 << 4);
+        config.swap_grave_esc           = bits & (1 << 5);
+        config.swap_backslash_backspace = bits & (1 << 6);
+        config.nkro                     = bits & (1 << 7);
+        config.swap_lctl_lgui           = bits & (1 << 8);
+        config.swap_rctl_rgui           = bits & (1 << 9);
+        keymap_config                   = config;
+        ASSERT_EQ(compare_all_keycodes(), 0u);
+    }
+}
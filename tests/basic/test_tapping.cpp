@@ -17,6 +17,10 @@
 #include "test_common.hpp"
 #include "action_tapping.h"
 
+extern "C" {
+void advance_time(uint32_t ms);
+}
+
 using testing::_;
 using testing::InSequence;
 
@@ -95,3 +99,75 @@ TEST_F(Tapping, ANewTapWithinTappingTermIsBuggy) {
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT))).Times(1);
     idle_for(TAPPING_TERM);
 }
+
+TEST_F(Tapping, TapA_SHFT_T_KeyIsTimedFromTheScanThatSawIt) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    run_one_scan_loop();
+    press_key(7, 0);
+    // Tapping keys does nothing on press
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // Both keys are released in the same scan, but only one is processed per
+    // keyboard_task(), and a slow pass delays the second past the tapping term
+    release_key(0, 0);
+    release_key(7, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    keyboard_task();
+    advance_time(TAPPING_TERM);
+    // The release was seen within the tapping term, so it is still a tap
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_P)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(Tapping, KeyWaitingFromAnEarlierScanDoesNotEndTheTappingTerm) {
+    TestDriver driver;
+    InSequence s;
+
+    // C and D are seen in the same scan, and D waits while C is processed
+    press_key(0, 3);
+    press_key(1, 3);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_C)));
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // The tapping key is in an earlier row, so it is processed before D, and
+    // D's event is older than the tapping key's. D still interrupts the tapping
+    // key within the tapping term, so the tapping key isn't decided yet.
+    advance_time(5);
+    press_key(7, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // The same as when D is pressed after the tapping key
+    release_key(7, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_C, KC_LSFT)));
+    idle_for(2);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Tapping, HoldA_SHFT_T_KeyAfterALongIdleReportsShift) {
+    TestDriver driver;
+    InSequence s;
+
+    // A gap longer than half the 16 bit timer, e.g. while the host is suspended
+    run_one_scan_loop();
+    advance_time(40000);
+    press_key(7, 0);
+    // Tapping keys does nothing on press
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // The hold is decided once the tapping term has passed
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    idle_for(TAPPING_TERM + 1);
+}
@@ -0,0 +1,99 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench_counters.hpp"
+
+#include <chrono>
+
+#ifdef __linux__
+#    include <linux/perf_event.h>
+#    include <sys/ioctl.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#    include <string.h>
+
+static int open_counter(uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.size           = sizeof(attr);
+    attr.config         = config;
+    attr.disabled       = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static uint64_t read_counter(int fd) {
+    uint64_t value = 0;
+    if (fd < 0 || read(fd, &value, sizeof(value)) != sizeof(value)) {
+        return 0;
+    }
+    return value;
+}
+
+static void reset_and_enable(int fd) {
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+static void disable(int fd) {
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+}
+#endif
+
+static uint64_t now_ns() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+
+BenchCounters::BenchCounters() : m_cycles_fd(-1), m_instructions_fd(-1), m_start_ns(0) {
+#ifdef __linux__
+    m_cycles_fd       = open_counter(PERF_COUNT_HW_CPU_CYCLES);
+    m_instructions_fd = open_counter(PERF_COUNT_HW_INSTRUCTIONS);
+#endif
+}
+
+BenchCounters::~BenchCounters() {
+#ifdef __linux__
+    if (m_cycles_fd >= 0) close(m_cycles_fd);
+    if (m_instructions_fd >= 0) close(m_instructions_fd);
+#endif
+}
+
+void BenchCounters::start() {
+#ifdef __linux__
+    reset_and_enable(m_cycles_fd);
+    reset_and_enable(m_instructions_fd);
+#endif
+    m_start_ns = now_ns();
+}
+
+BenchCounters::Sample BenchCounters::stop() {
+    Sample sample;
+    sample.nanoseconds = now_ns() - m_start_ns;
+#ifdef __linux__
+    disable(m_cycles_fd);
+    disable(m_instructions_fd);
+    sample.cycles       = read_counter(m_cycles_fd);
+    sample.instructions = read_counter(m_instructions_fd);
+#else
+    sample.cycles       = 0;
+    sample.instructions = 0;
+#endif
+    return sample;
+}
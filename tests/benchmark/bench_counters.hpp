@@ -0,0 +1,46 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/* Measures the CPU cost of a piece of code on the host. Wall time is always
+ * available, cycles and retired instructions only where the kernel exposes
+ * hardware performance counters (Linux perf events).
+ */
+class BenchCounters {
+public:
+    struct Sample {
+        uint64_t nanoseconds;
+        uint64_t cycles;
+        uint64_t instructions;
+    };
+
+    BenchCounters();
+    ~BenchCounters();
+
+    bool has_cycles() const { return m_cycles_fd >= 0; }
+    bool has_instructions() const { return m_instructions_fd >= 0; }
+
+    void   start();
+    Sample stop();
+
+private:
+    int      m_cycles_fd;
+    int      m_instructions_fd;
+    uint64_t m_start_ns;
+};
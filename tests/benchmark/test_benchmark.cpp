@@ -0,0 +1,232 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include "bench_counters.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <string>
+#include <vector>
+
+extern "C" {
+void advance_time(uint32_t ms);
+}
+
+using testing::_;
+using testing::AnyNumber;
+using testing::Invoke;
+
+/* Replays key traces through keyboard_task() and reports what each matrix
+ * change costs. Latency is in scans, which are 1ms apart in the tests, from
+ * the matrix change to the next HID report.
+ *
+ * QMK_BENCH_REPEAT sets how many times each trace is replayed (default 20).
+ * QMK_BENCH_TRACE names a recorded trace file to replay as well, with one
+ * "<time ms> <col> <row> <1 = pressed, 0 = released>" line per matrix change.
+ */
+
+struct TraceEvent {
+    uint32_t time;
+    uint8_t  col;
+    uint8_t  row;
+    bool     pressed;
+};
+
+typedef std::vector<TraceEvent> Trace;
+
+static void tap(Trace& trace, uint32_t time, uint8_t col, uint8_t row, uint32_t hold) {
+    trace.push_back({time, col, row, true});
+    trace.push_back({time + hold, col, row, false});
+}
+
+static void sort_trace(Trace& trace) {
+    std::stable_sort(trace.begin(), trace.end(), [](const TraceEvent& a, const TraceEvent& b) { return a.time < b.time; });
+}
+
+static unsigned bench_repeat() {
+    const char* repeat = getenv("QMK_BENCH_REPEAT");
+    return repeat ? std::max(1, atoi(repeat)) : 20;
+}
+
+template <typename T>
+static T percentile(std::vector<T> values, unsigned p) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    return values[(values.size() - 1) * p / 100];
+}
+
+class Benchmark : public TestFixture {
+protected:
+    struct Result {
+        std::vector<uint64_t> event_ns, event_cycles, event_instructions;
+        std::vector<uint64_t> idle_ns;
+        std::vector<uint32_t> latency;
+        unsigned              edges     = 0;
+        unsigned              reports   = 0;
+        unsigned              unreported = 0;
+    };
+
+    Result replay(const Trace& trace, unsigned repeat) {
+        TestDriver             driver;
+        BenchCounters          counters;
+        Result                 result;
+        std::deque<uint32_t>   pending;
+        uint32_t               now = 0;
+
+        EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber()).WillRepeatedly(Invoke([&](report_keyboard_t&) {
+            result.reports++;
+            while (!pending.empty()) {
+                result.latency.push_back(now - pending.front());
+                pending.pop_front();
+            }
+        }));
+
+        for (unsigned r = 0; r < repeat; r++) {
+            uint32_t start = now;
+            size_t   next  = 0;
+            uint32_t end   = start + (trace.empty() ? 0 : trace.back().time) + TAPPING_TERM * 2;
+            while (now < end) {
+                bool edge = false;
+                while (next < trace.size() && start + trace[next].time <= now) {
+                    const TraceEvent& e = trace[next++];
+                    if (e.pressed) {
+                        press_key(e.col, e.row);
+                    } else {
+                        release_key(e.col, e.row);
+                    }
+                    pending.push_back(now);
+                    result.edges++;
+                    edge = true;
+                }
+
+                counters.start();
+                keyboard_task();
+                BenchCounters::Sample sample = counters.stop();
+                if (edge) {
+                    result.event_ns.push_back(sample.nanoseconds);
+                    result.event_cycles.push_back(sample.cycles);
+                    result.event_instructions.push_back(sample.instructions);
+                } else {
+                    result.idle_ns.push_back(sample.nanoseconds);
+                }
+
+                advance_time(1);
+                now++;
+            }
+            result.unreported += pending.size();
+            pending.clear();
+        }
+
+        print_result(counters, result);
+        testing::Mock::VerifyAndClearExpectations(&driver);
+        return result;
+    }
+
+    void print_result(const BenchCounters& counters, const Result& result) {
+        const char* name = testing::UnitTest::GetInstance()->current_test_info()->name();
+        printf("[ BENCH    ] %s: %u matrix changes, %u reports, %u without a report\n", name, result.edges, result.reports, result.unreported);
+        printf("[ BENCH    ] %s: event scan ns p50 %llu p99 %llu max %llu, idle scan ns p50 %llu\n", name, (unsigned long long)percentile(result.event_ns, 50), (unsigned long long)percentile(result.event_ns, 99), (unsigned long long)percentile(result.event_ns, 100), (unsigned long long)percentile(result.idle_ns, 50));
+        if (counters.has_cycles()) {
+            printf("[ BENCH    ] %s: event scan cycles p50 %llu p99 %llu\n", name, (unsigned long long)percentile(result.event_cycles, 50), (unsigned long long)percentile(result.event_cycles, 99));
+        }
+        if (counters.has_instructions()) {
+            printf("[ BENCH    ] %s: event scan instructions p50 %llu p99 %llu\n", name, (unsigned long long)percentile(result.event_instructions, 50), (unsigned long long)percentile(result.event_instructions, 99));
+        }
+        printf("[ BENCH    ] %s: latency to report in scans p50 %u p99 %u max %u\n", name, percentile(result.latency, 50), percentile(result.latency, 99), percentile(result.latency, 100));
+    }
+};
+
+TEST_F(Benchmark, Typing) {
+    Trace trace;
+    for (uint8_t i = 0; i < 20; i++) {
+        tap(trace, i * 80, i % MATRIX_COLS, i / MATRIX_COLS, 40);
+    }
+    sort_trace(trace);
+    Result result = replay(trace, bench_repeat());
+    EXPECT_EQ(result.unreported, 0u);
+}
+
+TEST_F(Benchmark, Rolls) {
+    Trace trace;
+    for (uint8_t i = 0; i < 20; i++) {
+        tap(trace, i * 30, i % MATRIX_COLS, i / MATRIX_COLS, 70);
+    }
+    sort_trace(trace);
+    Result result = replay(trace, bench_repeat());
+    EXPECT_EQ(result.unreported, 0u);
+}
+
+TEST_F(Benchmark, Combos) {
+    Trace trace;
+    for (uint8_t i = 0; i < 10; i++) {
+        // D + F is a combo, followed by a normal key
+        tap(trace, i * 200, 3, 0, 60);
+        tap(trace, i * 200 + 5, 5, 0, 60);
+        tap(trace, i * 200 + 100, 0, 1, 40);
+    }
+    sort_trace(trace);
+    replay(trace, bench_repeat());
+}
+
+TEST_F(Benchmark, TapHold) {
+    Trace trace;
+    for (uint8_t i = 0; i < 5; i++) {
+        // tapped mod tap, then held mod tap with a key
+        tap(trace, i * 800, 0, 2, 50);
+        tap(trace, i * 800 + 200, 0, 2, TAPPING_TERM + 200);
+        tap(trace, i * 800 + 200 + TAPPING_TERM + 50, 4, 0, 50);
+    }
+    sort_trace(trace);
+    replay(trace, bench_repeat());
+}
+
+TEST_F(Benchmark, LayerSwitches) {
+    Trace trace;
+    for (uint8_t i = 0; i < 5; i++) {
+        // MO(1) with three keys, then LT(1, KC_ENT) tapped
+        tap(trace, i * 600, 2, 2, 300);
+        tap(trace, i * 600 + 50, 0, 0, 40);
+        tap(trace, i * 600 + 120, 1, 0, 40);
+        tap(trace, i * 600 + 190, 2, 0, 40);
+        tap(trace, i * 600 + 400, 1, 2, 50);
+    }
+    sort_trace(trace);
+    replay(trace, bench_repeat());
+}
+
+TEST_F(Benchmark, RecordedTrace) {
+    const char* path = getenv("QMK_BENCH_TRACE");
+    if (!path) {
+        return;
+    }
+    FILE* file = fopen(path, "r");
+    ASSERT_NE(file, nullptr) << "can't open " << path;
+    Trace    trace;
+    unsigned time, col, row, pressed;
+    while (fscanf(file, "%u %u %u %u", &time, &col, &row, &pressed) == 4) {
+        ASSERT_LT(col, (unsigned)MATRIX_COLS);
+        ASSERT_LT(row, (unsigned)MATRIX_ROWS);
+        trace.push_back({time, (uint8_t)col, (uint8_t)row, pressed != 0});
+    }
+    fclose(file);
+    sort_trace(trace);
+    replay(trace, bench_repeat());
+}
@@ -0,0 +1,44 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+
+enum combos { AB_X, BC_Y, ABC_Z, CA_DUP };
+
+const uint16_t PROGMEM ab_combo[]  = {KC_A, KC_B, COMBO_END};
+const uint16_t PROGMEM bc_combo[]  = {KC_B, KC_C, COMBO_END};
+const uint16_t PROGMEM abc_combo[] = {KC_C, KC_B, KC_A, COMBO_END};
+const uint16_t PROGMEM ca_combo[]  = {KC_C, KC_E, KC_C, COMBO_END};
+// not in key_combos, swapped in by the tests
+const uint16_t PROGMEM ad_combo[] = {KC_A, KC_D, COMBO_END};
+
+combo_t key_combos[COMBO_COUNT] = {
+    [AB_X]   = COMBO(ab_combo, KC_X),
+    [BC_Y]   = COMBO(bc_combo, KC_Y),
+    [ABC_Z]  = COMBO(abc_combo, KC_Z),
+    [CA_DUP] = COMBO(ca_combo, KC_W),
+};
+
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] =
+        {
+            // 0    1      2      3      4      5      6      7      8      9
+            {KC_A, KC_B, KC_C, KC_D, KC_E, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+            {KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+            {KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+            {KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+        },
+};
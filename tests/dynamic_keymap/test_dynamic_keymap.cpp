@@ -0,0 +1,66 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "dynamic_keymap.h"
+#include "eeprom.h"
+}
+
+using testing::_;
+using testing::AnyNumber;
+
+class DynamicKeymap : public TestFixture {
+   public:
+    // load the dynamic keymap from the keymap above
+    DynamicKeymap() { dynamic_keymap_reset(); }
+
+    // keycodes are stored big-endian
+    uint16_t eeprom_keycode(uint8_t layer, uint8_t row, uint8_t column) {
+        uint8_t *address = (uint8_t *)dynamic_keymap_key_to_eeprom_address(layer, row, column);
+        return (eeprom_read_byte(address) << 8) | eeprom_read_byte(address + 1);
+    }
+};
+
+TEST_F(DynamicKeymap, WritesAreDelayed) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    dynamic_keymap_set_keycode(1, 2, 3, KC_Z);
+    EXPECT_EQ(dynamic_keymap_get_keycode(1, 2, 3), KC_Z);
+    EXPECT_EQ(eeprom_keycode(1, 2, 3), KC_TRNS);
+
+    idle_for(DYNAMIC_KEYMAP_WRITE_DELAY / 2);
+    EXPECT_EQ(eeprom_keycode(1, 2, 3), KC_TRNS);
+
+    idle_for(DYNAMIC_KEYMAP_WRITE_DELAY);
+    EXPECT_EQ(eeprom_keycode(1, 2, 3), KC_Z);
+}
+
+TEST_F(DynamicKeymap, ResetKeyboardFlushesPendingWrites) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    dynamic_keymap_set_keycode(0, 0, 0, KC_B);
+    dynamic_keymap_set_keycode(1, 3, 9, KC_C);
+    EXPECT_EQ(eeprom_keycode(0, 0, 0), KC_A);
+    EXPECT_EQ(eeprom_keycode(1, 3, 9), KC_TRNS);
+
+    reset_keyboard();
+    EXPECT_EQ(eeprom_keycode(0, 0, 0), KC_B);
+    EXPECT_EQ(eeprom_keycode(1, 3, 9), KC_C);
+}
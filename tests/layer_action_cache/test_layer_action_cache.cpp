@@ -0,0 +1,146 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "dynamic_keymap.h"
+}
+
+using testing::_;
+using testing::AnyNumber;
+using testing::Mock;
+
+class LayerActionCache : public TestFixture {
+   public:
+    // load the dynamic keymap from the keymap above
+    LayerActionCache() { dynamic_keymap_reset(); }
+
+    void tap_and_expect(TestDriver& driver, uint8_t col, uint8_t row, uint8_t keycode) {
+        press_key(col, row);
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(keycode)));
+        run_one_scan_loop();
+        Mock::VerifyAndClearExpectations(&driver);
+        release_key(col, row);
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+        run_one_scan_loop();
+        Mock::VerifyAndClearExpectations(&driver);
+    }
+
+    // layer changes clear the keyboard, which may send empty reports
+    void expect_layer_change(TestDriver& driver) { EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber()); }
+};
+
+TEST_F(LayerActionCache, FollowsLayerSwitchKeys) {
+    TestDriver driver;
+
+    tap_and_expect(driver, 0, 0, KC_A);
+
+    expect_layer_change(driver);
+    press_key(1, 0);
+    run_one_scan_loop();
+    Mock::VerifyAndClearExpectations(&driver);
+    tap_and_expect(driver, 0, 0, KC_B);
+    // transparent keys fall through to the base layer
+    tap_and_expect(driver, 2, 0, KC_LSFT);
+
+    expect_layer_change(driver);
+    release_key(1, 0);
+    run_one_scan_loop();
+    Mock::VerifyAndClearExpectations(&driver);
+    tap_and_expect(driver, 0, 0, KC_A);
+}
+
+TEST_F(LayerActionCache, KeyReleasedAfterLayerChangeUsesPressLayer) {
+    TestDriver driver;
+
+    expect_layer_change(driver);
+    press_key(1, 0);
+    run_one_scan_loop();
+    Mock::VerifyAndClearExpectations(&driver);
+
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
+    run_one_scan_loop();
+    Mock::VerifyAndClearExpectations(&driver);
+
+    expect_layer_change(driver);
+    release_key(1, 0);
+    run_one_scan_loop();
+    Mock::VerifyAndClearExpectations(&driver);
+
+    // KC_B is still held and released, not KC_A
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+    Mock::VerifyAndClearExpectations(&driver);
+
+    tap_and_expect(driver, 0, 0, KC_A);
+}
+
+TEST_F(LayerActionCache, FollowsLayerStateChangesFromCode) {
+    TestDriver driver;
+
+    tap_and_expect(driver, 0, 0, KC_A);
+
+    expect_layer_change(driver);
+    layer_on(2);
+    Mock::VerifyAndClearExpectations(&driver);
+    tap_and_expect(driver, 0, 0, KC_C);
+
+    expect_layer_change(driver);
+    layer_on(1);
+    layer_off(2);
+    Mock::VerifyAndClearExpectations(&driver);
+    tap_and_expect(driver, 0, 0, KC_B);
+
+    expect_layer_change(driver);
+    layer_clear();
+    Mock::VerifyAndClearExpectations(&driver);
+    tap_and_expect(driver, 0, 0, KC_A);
+}
+
+TEST_F(LayerActionCache, FollowsDefaultLayerChanges) {
+    TestDriver driver;
+
+    tap_and_expect(driver, 0, 0, KC_A);
+
+    expect_layer_change(driver);
+    default_layer_set(1UL << 2);
+    Mock::VerifyAndClearExpectations(&driver);
+    tap_and_expect(driver, 0, 0, KC_C);
+
+    expect_layer_change(driver);
+    default_layer_set(1);
+    Mock::VerifyAndClearExpectations(&driver);
+    tap_and_expect(driver, 0, 0, KC_A);
+}
+
+TEST_F(LayerActionCache, FollowsDynamicKeymapWrites) {
+    TestDriver driver;
+
+    tap_and_expect(driver, 0, 0, KC_A);
+    dynamic_keymap_set_keycode(0, 0, 0, KC_D);
+    tap_and_expect(driver, 0, 0, KC_D);
+
+    // a buffer write covering the key, keycodes are stored big endian
+    uint8_t data[2] = {0x00, KC_E};
+    dynamic_keymap_set_buffer(0, sizeof(data), data);
+    tap_and_expect(driver, 0, 0, KC_E);
+
+    dynamic_keymap_reset();
+    tap_and_expect(driver, 0, 0, KC_A);
+}
@@ -0,0 +1,105 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+using testing::_;
+using testing::ElementsAre;
+using testing::InSequence;
+
+extern "C" {
+extern uint16_t user_keycodes[8];
+extern uint8_t  user_keycode_count;
+extern uint16_t user_blocked_keycode;
+}
+
+// Each handler must see the same keys in the same order as with the plain chain of handlers.
+class ProcessRecordDispatch : public TestFixture {
+   public:
+    ProcessRecordDispatch() {
+        user_keycode_count   = 0;
+        user_blocked_keycode = KC_NO;
+    }
+
+    std::vector<uint16_t> seen_by_user(void) { return std::vector<uint16_t>(user_keycodes, user_keycodes + user_keycode_count); }
+};
+
+TEST_F(ProcessRecordDispatch, UserHandlerSeesEveryKeycode) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+    press_key(0, 0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    run_one_scan_loop();
+    press_key(1, 0);
+    run_one_scan_loop();
+    release_key(1, 0);
+    run_one_scan_loop();
+    EXPECT_THAT(seen_by_user(), ElementsAre(KC_A, KC_A, KC_GESC, KC_GESC));
+}
+
+TEST_F(ProcessRecordDispatch, DispatchedHandlerRuns) {
+    TestDriver driver;
+    InSequence s;
+    press_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_ESC)));
+    run_one_scan_loop();
+    release_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(ProcessRecordDispatch, EarlierHandlerStopsDispatchedHandler) {
+    TestDriver driver;
+    // process_record_user runs before grave escape, so grave escape never sees the key
+    user_blocked_keycode = KC_GESC;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    press_key(1, 0);
+    run_one_scan_loop();
+    release_key(1, 0);
+    run_one_scan_loop();
+    EXPECT_THAT(seen_by_user(), ElementsAre(KC_GESC, KC_GESC));
+}
+
+TEST_F(ProcessRecordDispatch, DispatchedHandlerWithTwoRangesRuns) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+    bool swapped = keymap_config.swap_grave_esc;
+    press_key(3, 0);
+    run_one_scan_loop();
+    release_key(3, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(keymap_config.swap_grave_esc, !swapped);
+    keymap_config.swap_grave_esc = swapped;
+}
+
+TEST_F(ProcessRecordDispatch, HandlerForAllKeycodesSeesOtherKeys) {
+    TestDriver driver;
+    InSequence s;
+    // space cadet only sends its parenthesis if no other key was pressed while it was held
+    press_key(2, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    run_one_scan_loop();
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_A)));
+    run_one_scan_loop();
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    run_one_scan_loop();
+    release_key(2, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
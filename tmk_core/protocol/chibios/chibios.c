@@ -239,6 +239,9 @@ void protocol_task(void) {
     }
 #endif
 
+#ifdef USB_SOF_SYNC
+    usb_sof_wait();
+#endif
     keyboard_task();
 #ifdef CONSOLE_ENABLE
     console_task();
@@ -166,6 +166,171 @@ static const USBEndpointConfig shared_ep_config = {
 };
 #endif
 
+#ifdef USB_REPORT_QUEUE
+#    ifndef USB_REPORT_QUEUE_SIZE
+#        define USB_REPORT_QUEUE_SIZE 4
+#    endif
+#    if USB_REPORT_QUEUE_SIZE < 2
+#        error "USB_REPORT_QUEUE_SIZE must be at least 2"
+#    endif
+
+/* Reports waiting to go IN on one endpoint. Every report is copied into a
+ * slot, so callers may reuse their buffer as soon as it has been queued.
+ * The slot at head is the one being transmitted; the IN callback of the
+ * endpoint drops it and starts the next one, so the sender never has to
+ * wait for the host to poll unless every slot is in use. */
+typedef struct {
+    usbep_t  ep;
+    uint8_t  slot_size;
+    uint8_t  head;
+    uint8_t  count;
+    uint8_t  len[USB_REPORT_QUEUE_SIZE];
+    uint8_t *slots;
+} usb_report_queue_t;
+
+/* Folds report into the queued (not yet transmitted) report of the same
+ * length, returns false if the two have to be sent separately */
+typedef bool (*usb_report_merge_t)(uint8_t *queued, const uint8_t *report, uint8_t len);
+
+#    define DEFINE_USB_REPORT_QUEUE(name, epnum, size)                                                 \
+        static uint8_t            name##_slots[USB_REPORT_QUEUE_SIZE][size] __attribute__((aligned(4))); \
+        static usb_report_queue_t name = {.ep = epnum, .slot_size = size, .slots = &name##_slots[0][0]}
+
+#    ifndef KEYBOARD_SHARED_EP
+DEFINE_USB_REPORT_QUEUE(keyboard_report_queue, KEYBOARD_IN_EPNUM, KEYBOARD_EPSIZE);
+#    else
+#        define keyboard_report_queue shared_report_queue
+#    endif
+#    if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+DEFINE_USB_REPORT_QUEUE(mouse_report_queue, MOUSE_IN_EPNUM, MOUSE_EPSIZE);
+#    elif defined(MOUSE_ENABLE)
+#        define mouse_report_queue shared_report_queue
+#    endif
+#    ifdef SHARED_EP_ENABLE
+DEFINE_USB_REPORT_QUEUE(shared_report_queue, SHARED_IN_EPNUM, SHARED_EPSIZE);
+#    endif
+
+static inline uint8_t usb_report_queue_index(usb_report_queue_t *queue, uint8_t n) { return (queue->head + n) % USB_REPORT_QUEUE_SIZE; }
+
+static inline uint8_t *usb_report_queue_slot(usb_report_queue_t *queue, uint8_t index) { return queue->slots + index * queue->slot_size; }
+
+/* Starts transmitting the report at head if the endpoint is idle (I-class) */
+static void usb_report_queue_startI(usb_report_queue_t *queue) {
+    if (queue->count && !usbGetTransmitStatusI(&USB_DRIVER, queue->ep)) {
+        usbStartTransmitI(&USB_DRIVER, queue->ep, usb_report_queue_slot(queue, queue->head), queue->len[queue->head]);
+    }
+}
+
+/* Drops the report that has just made it IN and starts the next one (I-class) */
+static void usb_report_queue_completeI(usb_report_queue_t *queue) {
+    if (queue->count) {
+        queue->head = usb_report_queue_index(queue, 1);
+        queue->count--;
+    }
+    usb_report_queue_startI(queue);
+}
+
+/* Discards every queued report, the endpoints are reinitialised (I-class) */
+static void usb_report_queue_resetI(usb_report_queue_t *queue) {
+    queue->head  = 0;
+    queue->count = 0;
+}
+
+static void usb_report_queues_resetI(void) {
+#    ifndef KEYBOARD_SHARED_EP
+    usb_report_queue_resetI(&keyboard_report_queue);
+#    endif
+#    if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+    usb_report_queue_resetI(&mouse_report_queue);
+#    endif
+#    ifdef SHARED_EP_ENABLE
+    usb_report_queue_resetI(&shared_report_queue);
+#    endif
+}
+
+/* Queues a copy of report, merging it into the last pending report when
+ * merge allows it (I-class)
+ * returns false if the queue is full */
+static bool usb_report_queue_pushI(usb_report_queue_t *queue, const void *report, uint8_t len, usb_report_merge_t merge) {
+    if (len > queue->slot_size) {
+        len = queue->slot_size;
+    }
+
+    /* the report at head may already be on the wire, only later ones can be merged into */
+    if (queue->count > 1 && merge) {
+        uint8_t last = usb_report_queue_index(queue, queue->count - 1);
+        if (queue->len[last] == len && merge(usb_report_queue_slot(queue, last), report, len)) {
+            return true;
+        }
+    }
+
+    if (queue->count == USB_REPORT_QUEUE_SIZE) {
+        return false;
+    }
+
+    uint8_t index = usb_report_queue_index(queue, queue->count);
+    memcpy(usb_report_queue_slot(queue, index), report, len);
+    queue->len[index] = len;
+    queue->count++;
+    usb_report_queue_startI(queue);
+    return true;
+}
+
+/* Queues a copy of report, waiting for the endpoint only while the queue is full
+ * not callable from ISR, call in locked state
+ * returns false if the report was not queued */
+static bool usb_report_queue_sendS(usb_report_queue_t *queue, const void *report, uint8_t len, usb_report_merge_t merge, sysinterval_t timeout) {
+    while (!usb_report_queue_pushI(queue, report, len, merge)) {
+        /* Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
+        if (osalThreadSuspendTimeoutS(&(&USB_DRIVER)->epc[queue->ep]->in_state->thread, timeout) == MSG_TIMEOUT) {
+            return false;
+        }
+
+        /* after osalThreadSuspendTimeoutS returns USB status might have changed */
+        if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Only repeated identical reports can be dropped without losing a key
+ * transition on the host side */
+static bool usb_report_merge_identical(uint8_t *queued, const uint8_t *report, uint8_t len) { return memcmp(queued, report, len) == 0; }
+
+#    ifdef MOUSE_ENABLE
+/* Motion of consecutive reports with the same buttons can be summed up,
+ * as long as the result still fits into a single report */
+static bool usb_report_merge_mouse(uint8_t *queued, const uint8_t *report, uint8_t len) {
+    report_mouse_t *      a = (report_mouse_t *)queued;
+    const report_mouse_t *b = (const report_mouse_t *)report;
+
+    if (len != sizeof(report_mouse_t) || a->buttons != b->buttons) {
+        return false;
+    }
+#        ifdef MOUSE_SHARED_EP
+    if (a->report_id != b->report_id) {
+        return false;
+    }
+#        endif
+
+    int16_t x = a->x + b->x;
+    int16_t y = a->y + b->y;
+    int16_t v = a->v + b->v;
+    int16_t h = a->h + b->h;
+    if (x < -127 || x > 127 || y < -127 || y > 127 || v < -127 || v > 127 || h < -127 || h > 127) {
+        return false;
+    }
+
+    a->x = x;
+    a->y = y;
+    a->v = v;
+    a->h = h;
+    return true;
+}
+#    endif
+#endif
+
 #if STM32_USB_USE_OTG1
 typedef struct {
     size_t              queue_capacity_in;
@@ -478,6 +643,9 @@ static void usb_event_cb(USBDriver *usbp, usbevent_t event) {
                 }
                 qmkusbConfigureHookI(&drivers.array[i].driver);
             }
+#ifdef USB_REPORT_QUEUE
+            usb_report_queues_resetI();
+#endif
             osalSysUnlockFromISR();
             if (last_suspend_state) {
                 usb_event_queue_enqueue(USB_EVENT_WAKEUP);
@@ -495,6 +663,11 @@ static void usb_event_cb(USBDriver *usbp, usbevent_t event) {
                 qmkusbSuspendHookI(&drivers.array[i].driver);
                 chSysUnlockFromISR();
             }
+#ifdef USB_REPORT_QUEUE
+            chSysLockFromISR();
+            usb_report_queues_resetI();
+            chSysUnlockFromISR();
+#endif
             return;
 
         case USB_EVENT_WAKEUP:
@@ -748,16 +921,55 @@ __attribute__((weak)) void restart_usb_driver(USBDriver *usbp) {
 /* keyboard IN callback hander (a kbd report has made it IN) */
 #ifndef KEYBOARD_SHARED_EP
 void kbd_in_cb(USBDriver *usbp, usbep_t ep) {
-    /* STUB */
     (void)usbp;
     (void)ep;
+#    ifdef USB_REPORT_QUEUE
+    osalSysLockFromISR();
+    usb_report_queue_completeI(&keyboard_report_queue);
+    osalSysUnlockFromISR();
+#    endif
 }
 #endif
 
+#ifdef USB_SOF_SYNC
+#    ifndef USB_SOF_SYNC_TIMEOUT
+#        define USB_SOF_SYNC_TIMEOUT 2
+#    endif
+static volatile uint16_t  usb_sof_frame  = 0;
+static thread_reference_t usb_sof_thread = NULL;
+#endif
+
 /* start-of-frame handler
  * TODO: i guess it would be better to re-implement using timers,
  *  so that this is not going to have to be checked every 1ms */
-void kbd_sof_cb(USBDriver *usbp) { (void)usbp; }
+void kbd_sof_cb(USBDriver *usbp) {
+    (void)usbp;
+#ifdef USB_SOF_SYNC
+    osalSysLockFromISR();
+    usb_sof_frame++;
+    osalThreadResumeI(&usb_sof_thread, MSG_OK);
+    osalSysUnlockFromISR();
+#endif
+}
+
+#ifdef USB_SOF_SYNC
+/* wait for the start of the next USB frame, so that the scan that follows
+ * has its report ready when the host polls during that frame
+ * returns straight away if a frame has started since the last call, so a
+ * slow loop doesn't lose another frame, and gives up after
+ * USB_SOF_SYNC_TIMEOUT ms in case the host stops sending SOFs
+ * not callable from ISR or locked state */
+void usb_sof_wait(void) {
+    static uint16_t last_frame = 0;
+
+    osalSysLock();
+    if (usb_sof_frame == last_frame && usbGetDriverStateI(&USB_DRIVER) == USB_ACTIVE) {
+        osalThreadSuspendTimeoutS(&usb_sof_thread, TIME_MS2I(USB_SOF_SYNC_TIMEOUT));
+    }
+    last_frame = usb_sof_frame;
+    osalSysUnlock();
+}
+#endif
 
 /* Idle requests timer code
  * callback (called from ISR, unlocked state) */
@@ -779,9 +991,16 @@ static void keyboard_idle_timer_cb(void *arg) {
     if (keyboard_idle && keyboard_protocol) {
 #endif /* NKRO_ENABLE */
         /* TODO: are we sure we want the KBD_ENDPOINT? */
+#ifdef USB_REPORT_QUEUE
+        /* a queued report already tells the host the current state */
+        if (!keyboard_report_queue.count) {
+            usb_report_queue_pushI(&keyboard_report_queue, &keyboard_report_sent, KEYBOARD_EPSIZE, NULL);
+        }
+#else
         if (!usbGetTransmitStatusI(usbp, KEYBOARD_IN_EPNUM)) {
             usbStartTransmitI(usbp, KEYBOARD_IN_EPNUM, (uint8_t *)&keyboard_report_sent, KEYBOARD_EPSIZE);
         }
+#endif
         /* rearm the timer */
         chVTSetI(&keyboard_idle_timer, 4 * TIME_MS2I(keyboard_idle), keyboard_idle_timer_cb, (void *)usbp);
     }
@@ -802,7 +1021,27 @@ void send_keyboard(report_keyboard_t *report) {
         goto unlock;
     }
 
-#ifdef NKRO_ENABLE
+#ifdef USB_REPORT_QUEUE
+#    ifdef NKRO_ENABLE
+    if (keymap_config.nkro && keyboard_protocol) { /* NKRO protocol */
+        if (!usb_report_queue_sendS(&shared_report_queue, report, sizeof(struct nkro_report), usb_report_merge_identical, TIME_INFINITE)) {
+            goto unlock;
+        }
+    } else
+#    endif /* NKRO_ENABLE */
+    {      /* regular protocol */
+        bool queued;
+        if (keyboard_protocol) {
+            queued = usb_report_queue_sendS(&keyboard_report_queue, report, KEYBOARD_REPORT_SIZE, usb_report_merge_identical, TIME_INFINITE);
+        } else { /* boot protocol */
+            queued = usb_report_queue_sendS(&keyboard_report_queue, &report->mods, 8, usb_report_merge_identical, TIME_INFINITE);
+        }
+        if (!queued) {
+            goto unlock;
+        }
+    }
+#else /* USB_REPORT_QUEUE */
+#    ifdef NKRO_ENABLE
     if (keymap_config.nkro && keyboard_protocol) { /* NKRO protocol */
         /* need to wait until the previous packet has made it through */
         /* can rewrite this using the synchronous API, then would wait
@@ -823,7 +1062,7 @@ void send_keyboard(report_keyboard_t *report) {
         }
         usbStartTransmitI(&USB_DRIVER, SHARED_IN_EPNUM, (uint8_t *)report, sizeof(struct nkro_report));
     } else
-#endif /* NKRO_ENABLE */
+#    endif /* NKRO_ENABLE */
     {  /* regular protocol */
         /* need to wait until the previous packet has made it through */
         /* busy wait, should be short and not very common */
@@ -849,6 +1088,7 @@ void send_keyboard(report_keyboard_t *report) {
         }
         usbStartTransmitI(&USB_DRIVER, KEYBOARD_IN_EPNUM, data, size);
     }
+#endif /* USB_REPORT_QUEUE */
     keyboard_report_sent = *report;
 
 unlock:
@@ -867,6 +1107,11 @@ unlock:
 void mouse_in_cb(USBDriver *usbp, usbep_t ep) {
     (void)usbp;
     (void)ep;
+#        ifdef USB_REPORT_QUEUE
+    osalSysLockFromISR();
+    usb_report_queue_completeI(&mouse_report_queue);
+    osalSysUnlockFromISR();
+#        endif
 }
 #    endif
 
@@ -877,6 +1122,10 @@ void send_mouse(report_mouse_t *report) {
         return;
     }
 
+#    ifdef USB_REPORT_QUEUE
+    /* same 10ms limit as below, in case the host never polls the mouse */
+    usb_report_queue_sendS(&mouse_report_queue, report, sizeof(report_mouse_t), usb_report_merge_mouse, TIME_MS2I(10));
+#    else
     if (usbGetTransmitStatusI(&USB_DRIVER, MOUSE_IN_EPNUM)) {
         /* Need to either suspend, or loop and call unlock/lock during
          * every iteration - otherwise the system will remain locked,
@@ -888,6 +1137,7 @@ void send_mouse(report_mouse_t *report) {
         }
     }
     usbStartTransmitI(&USB_DRIVER, MOUSE_IN_EPNUM, (uint8_t *)report, sizeof(report_mouse_t));
+#    endif
     osalSysUnlock();
 }
 
@@ -902,9 +1152,13 @@ void send_mouse(report_mouse_t *report) { (void)report; }
 #ifdef SHARED_EP_ENABLE
 /* shared IN callback hander */
 void shared_in_cb(USBDriver *usbp, usbep_t ep) {
-    /* STUB */
     (void)usbp;
     (void)ep;
+#    ifdef USB_REPORT_QUEUE
+    osalSysLockFromISR();
+    usb_report_queue_completeI(&shared_report_queue);
+    osalSysUnlockFromISR();
+#    endif
 }
 #endif
 
@@ -921,10 +1175,15 @@ static void send_extra(uint8_t report_id, uint16_t data) {
         return;
     }
 
+#    ifdef USB_REPORT_QUEUE
+    report_extra_t report = {.report_id = report_id, .usage = data};
+    usb_report_queue_sendS(&shared_report_queue, &report, sizeof(report_extra_t), usb_report_merge_identical, TIME_INFINITE);
+#    else
     static report_extra_t report;
     report = (report_extra_t){.report_id = report_id, .usage = data};
 
     usbStartTransmitI(&USB_DRIVER, SHARED_IN_EPNUM, (uint8_t *)&report, sizeof(report_extra_t));
+#    endif
     osalSysUnlock();
 }
 #endif
@@ -950,7 +1209,11 @@ void send_digitizer(report_digitizer_t *report) {
         return;
     }
 
+#        ifdef USB_REPORT_QUEUE
+    usb_report_queue_sendS(&shared_report_queue, report, sizeof(report_digitizer_t), usb_report_merge_identical, TIME_INFINITE);
+#        else
     usbStartTransmitI(&USB_DRIVER, DIGITIZER_IN_EPNUM, (uint8_t *)report, sizeof(report_digitizer_t));
+#        endif
     osalSysUnlock();
 #    else
     chnWrite(&drivers.digitizer_driver.driver, (uint8_t *)report, sizeof(report_digitizer_t));
@@ -61,6 +61,11 @@ void kbd_in_cb(USBDriver *usbp, usbep_t ep);
 /* start-of-frame handler */
 void kbd_sof_cb(USBDriver *usbp);
 
+#ifdef USB_SOF_SYNC
+/* Wait for the start of the next USB frame */
+void usb_sof_wait(void);
+#endif /* USB_SOF_SYNC */
+
 #ifdef NKRO_ENABLE
 /* nkro IN callback hander */
 void nkro_in_cb(USBDriver *usbp, usbep_t ep);
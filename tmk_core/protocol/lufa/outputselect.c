@@ -13,6 +13,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "outputselect.h"
+#include "action_util.h"
 
 #if defined(PROTOCOL_LUFA)
 #    include "lufa.h"
@@ -31,6 +32,8 @@ uint8_t desired_output = OUTPUT_DEFAULT;
 void set_output(uint8_t output) {
     set_output_user(output);
     desired_output = output;
+    // the next report has to be sent in full to the new output
+    clear_sent_report();
 }
 
 /** \brief Set Output User
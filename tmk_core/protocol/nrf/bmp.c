@@ -595,9 +595,15 @@ static bool usb_enabled = true;
 static bool ble_enabled = true;
 
 bool get_ble_enabled() { return ble_enabled & has_ble; }
-void set_ble_enabled(bool enabled) { ble_enabled = enabled; }
+void set_ble_enabled(bool enabled) {
+    ble_enabled = enabled;
+    clear_sent_report();
+}
 bool get_usb_enabled() { return usb_enabled & has_usb; }
-void set_usb_enabled(bool enabled) { usb_enabled = enabled; }
+void set_usb_enabled(bool enabled) {
+    usb_enabled = enabled;
+    clear_sent_report();
+}
 void select_ble(void) {
     if (usb_enabled) {
         report_keyboard_t report_keyboard = {0};
@@ -607,6 +613,8 @@ void select_ble(void) {
     }
     ble_enabled = true;
     usb_enabled = false;
+    // the driver is the same, so the next report has to be sent in full
+    clear_sent_report();
 }
 void select_usb(void) {
     if (ble_enabled) {
@@ -617,6 +625,8 @@ void select_usb(void) {
     }
     ble_enabled = false;
     usb_enabled = true;
+    // the driver is the same, so the next report has to be sent in full
+    clear_sent_report();
 }
 
 extern bool via_keymap_update_flag;
@@ -10,6 +10,8 @@ typedef struct {
     uint32_t (*get_device_row)(); // return matrix row count scanned in scan()
     uint32_t (*get_device_col)(); // return matrix col count scanned in scan()
     uint32_t (*scan)(matrix_row_t *matrix_raw); // scan matrix and store to matrix_raw[]
+    void (*idle)(bool idle); // optional: drive all outputs (idle) or release them again
+    uint32_t (*idle_scan)(); // optional: return non-zero if any key is down while idle
 } bmp_matrix_func_t;
 
 static const bmp_api_gpio_mode_t bmp_gpio_out_od = {
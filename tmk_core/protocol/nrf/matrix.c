@@ -131,6 +131,48 @@ void matrix_init(void) {
 #endif
 }
 
+#ifdef MATRIX_IDLE_SCAN_TIMEOUT
+/* Idle scanning
+ *
+ * Once no key has been down for MATRIX_IDLE_SCAN_TIMEOUT milliseconds, every
+ * output line is driven at once and each scan only reads the inputs, until
+ * one of them goes active. The full scan then runs again in the same call.
+ * Only matrix drivers that provide the idle() and idle_scan() hooks take part.
+ */
+static bool     matrix_idle       = false;
+static uint32_t matrix_idle_timer = 0;
+
+bool matrix_is_idle(void) { return matrix_idle; }
+
+static bool matrix_idle_should_scan(void) {
+    if (!matrix_idle) {
+        return true;
+    }
+    if (matrix_func->idle_scan()) {
+        matrix_func->idle(false);
+        matrix_idle       = false;
+        matrix_idle_timer = timer_read32();
+        return true;
+    }
+    return false;
+}
+
+static void matrix_idle_scanned(uint8_t matrix_offset) {
+    bool active = debouncing != 0;
+    for (uint8_t i = 0; i < matrix_func->get_device_row(); i++) {
+        active |= matrix_debouncing[i + matrix_offset] != 0;
+    }
+
+    if (active) {
+        matrix_idle_timer = timer_read32();
+    } else if (matrix_func->idle != NULL && matrix_func->idle_scan != NULL &&
+               timer_elapsed32(matrix_idle_timer) >= MATRIX_IDLE_SCAN_TIMEOUT) {
+        matrix_func->idle(true);
+        matrix_idle = true;
+    }
+}
+#endif
+
 __attribute__((weak)) uint8_t matrix_scan_impl(matrix_row_t *_matrix) {
     const bmp_api_config_t *config = BMPAPI->app.get_config();
     uint8_t                 matrix_offset =
@@ -139,9 +181,18 @@ __attribute__((weak)) uint8_t matrix_scan_impl(matrix_row_t *_matrix) {
             : config->matrix.rows - matrix_func->get_device_row();
     volatile int matrix_changed = 0;
 
+#ifdef MATRIX_IDLE_SCAN_TIMEOUT
+    if (matrix_idle_should_scan()) {
+        if (matrix_func->scan(matrix_debouncing)) {
+            debouncing = config->matrix.debounce;
+        }
+        matrix_idle_scanned(matrix_offset);
+    }
+#else
     if (matrix_func->scan(matrix_debouncing)) {
         debouncing = config->matrix.debounce;
     }
+#endif
 
     bmp_api_key_event_t key_state[16];
     matrix_changed = 0;
@@ -9,9 +9,13 @@ static uint32_t get_device_row() { return BMPAPI->app.get_config()->matrix.devic
 static uint32_t get_device_col() { return BMPAPI->app.get_config()->matrix.device_cols; };
 static uint32_t scan_row2col();
 static uint32_t scan_col2row();
+static void idle_row2col(bool idle);
+static void idle_col2row(bool idle);
+static uint32_t idle_scan_row2col();
+static uint32_t idle_scan_col2row();
 
-const bmp_matrix_func_t matrix_func_row2col = {init_row2col, get_device_row, get_device_col, scan_row2col};
-const bmp_matrix_func_t matrix_func_col2row = {init_col2row, get_device_row, get_device_col, scan_col2row};
+const bmp_matrix_func_t matrix_func_row2col = {init_row2col, get_device_row, get_device_col, scan_row2col, idle_row2col, idle_scan_row2col};
+const bmp_matrix_func_t matrix_func_col2row = {init_col2row, get_device_row, get_device_col, scan_col2row, idle_col2row, idle_scan_col2row};
 
 
 
@@ -83,6 +87,25 @@ static uint32_t scan_col2row(matrix_row_t *matrix_raw)
     return change;
 }
 
+// select every row at once, so that any pressed key pulls its col low
+static void idle_col2row(bool idle)
+{
+  const bmp_api_config_t *config = BMPAPI->app.get_config();
+
+  for(int i=0; i<config->matrix.device_rows; i++) {
+    if (idle) {
+      BMPAPI->gpio.clear_pin(config->matrix.row_pins[i]);
+    } else {
+      BMPAPI->gpio.set_pin(config->matrix.row_pins[i]);
+    }
+  }
+}
+
+static uint32_t idle_scan_col2row()
+{
+  return read_col_pins();
+}
+
 //
 //// row2col matrix
 //
@@ -119,6 +142,24 @@ static matrix_col_t read_col(uint8_t col)
   return col_state;
 }
 
+// select every col at once, so that any pressed key pulls its row low
+static void idle_row2col(bool idle)
+{
+  if (idle) {
+    const bmp_api_config_t *config = BMPAPI->app.get_config();
+    for(int i=0; i < config->matrix.device_cols; i++) {
+      BMPAPI->gpio.clear_pin(config->matrix.col_pins[i]);
+    }
+  } else {
+    unselect_cols();
+  }
+}
+
+static uint32_t idle_scan_row2col()
+{
+  return read_row_pins();
+}
+
 static void init_row2col() {
     const bmp_api_config_t *config = BMPAPI->app.get_config();
 
@@ -431,7 +431,11 @@ const USB_Descriptor_Device_t PROGMEM DeviceDescriptor = {
 #endif
 
 #ifndef USB_POLLING_INTERVAL_MS
-#    define USB_POLLING_INTERVAL_MS 10
+#    ifdef USB_SOF_SYNC
+#        define USB_POLLING_INTERVAL_MS 1
+#    else
+#        define USB_POLLING_INTERVAL_MS 10
+#    endif
 #endif
 
 /*